@@ -7,6 +7,7 @@ OTHER_FILES += \
     $$PWD/example_cusp/example_cusp.js \
     $$PWD/example_edge/plugin_example_edge.json \
     $$PWD/example_edge/example_edge.js \
+    $$PWD/example_native_cusp/plugin_example_native_cusp.json \
     $$PWD/external/common.js \
     $$PWD/external/config.js \
     $$PWD/external/plugin_external_config.json \
@@ -27,6 +28,7 @@ OTHER_FILES += \
     $$PWD/randomize/randomize.js \
     $$PWD/randomize/plugin_randomize.json \
     $$PWD/remove_duplicates/remove_duplicates.js \
+    $$PWD/remove_duplicates/remove_duplicates_worker.js \
     $$PWD/remove_duplicates/plugin_remove_duplicates.json \
     $$PWD/spiral/spiral.js \
     $$PWD/spiral/plugin_spiral.json \
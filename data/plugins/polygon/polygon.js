@@ -1,37 +1,35 @@
 if ( Dialog_Insert_Polygon.exec() )
 {
     var graph = new Graph();
-    
-    var last = null;
-    var first = null;
 
     var radius = (document.grid.enabled ? document.grid.size : 32)*3;
     
     var sides = Dialog_Insert_Polygon.spin_sides.value;
 
-    var middle = null;
-    if ( Dialog_Insert_Polygon.check_middle_node.checked )
-        middle = graph.add_node(0,0);
+    var middle = Dialog_Insert_Polygon.check_middle_node.checked;
+    var coordinates = [];
+    if ( middle )
+        coordinates.push(0,0);
 
     for ( var i = 0; i < sides; i++ )
     {
         var angle = 2*Math.PI*i/sides;
+        coordinates.push(radius*Math.cos(angle),-radius*Math.sin(angle));
+    }
 
-        var next = graph.add_node(radius*Math.cos(angle),-radius*Math.sin(angle));
-
-        if ( !first )
-            first = next;
+    var first = graph.add_nodes(coordinates);
+    if ( middle )
+        first++;
 
+    var links = [];
+    for ( var i = 0; i < sides; i++ )
+    {
         if ( middle )
-            graph.connect(middle,next);
-
-        if ( last )
-            graph.connect(last,next);
-
-        last = next;
-
+            links.push(first-1,first+i);
+        links.push(first+i,first+(i+1)%sides);
     }
-    graph.connect(last,first);
+
+    graph.connect_nodes(links);
 
     
     document.insert(graph,"Insert Polygon");
@@ -1,16 +1,22 @@
 var max_distance=window.dialog.get_number("Maximum distance","",document.grid.size/2,0);
 
-if ( !isNaN(max_distance) && document.graph.selected_nodes.length > 0 )
+var selected = document.graph.selected_node_indices();
+if ( !isNaN(max_distance) && selected.length > 0 )
 {
 	document.begin_macro("Randomize");
 
-	for ( var i = 0; i < document.graph.selected_nodes.length; i++ )
+	var positions = document.graph.node_positions();
+
+	for ( var i = 0; i < selected.length; i++ )
 	{
-		var node = document.graph.selected_nodes[i];
-		var line = new Line(node.pos,Point(node.pos.x+max_distance,node.pos.y));
-		line.angle = 360 * Math.random();
-		node.pos = line.pointAt(Math.random());
+		var x = 2*selected[i];
+		var angle = 2 * Math.PI * Math.random();
+		var distance = max_distance * Math.random();
+		positions[x] += distance*Math.cos(angle);
+		positions[x+1] -= distance*Math.sin(angle);
 	}
 
+	document.graph.set_node_positions(positions);
+
 	document.end_macro();
 }
\ No newline at end of file
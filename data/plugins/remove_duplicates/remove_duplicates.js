@@ -3,23 +3,5 @@ var radius = window.dialog.get_number("Radius","",0.1,0);
 
 if ( !isNaN(radius) )
 {
-	document.begin_macro("Remove Duplicates");
-	for ( var i = 0; i < document.graph.nodes.length; i++ )
-	{
-		var base = document.graph.nodes[i];
-		var colliding = document.graph.nodes_at(base.pos,radius);
-		for ( var j = 0; j < colliding.length; j++ )
-		{
-			if ( colliding[j] != base )
-			{
-				for ( var k = 0; k < colliding[j].edges.length; k++ )
-				{
-					if ( colliding[j].edges[k].other(colliding[j]) != base )
-						document.graph.connect(base,colliding[j].edges[k].other(colliding[j]))
-				}
-				document.graph.remove_node(colliding[j]);
-			}
-		}
-	}
-	document.end_macro();
-}
\ No newline at end of file
+	document.run_worker("remove_duplicates_worker.js",{ "radius": radius },"Remove Duplicates");
+}
@@ -1,17 +1,19 @@
-
 if ( Dialog.exec() )
 {
-	var prev_node = null;
 	var graph = new Graph;
+	var coordinates = [];
 	for ( var a = Dialog.start_angle.value; a <= Dialog.end_angle.value; a+= Dialog.step_angle.value )
 	{
 		var theta = Math.PI*a/180;
 		var radius = theta*Dialog.turn_size.value/(Math.PI*2);
-		var node = graph.add_node(radius*Math.cos(theta),-radius*Math.sin(theta));
-		if ( prev_node )
-			graph.connect(prev_node,node);
-		prev_node = node;
+		coordinates.push(radius*Math.cos(theta),-radius*Math.sin(theta));
 	}
 
+	var first = graph.add_nodes(coordinates);
+	var links = [];
+	for ( var i = first+1; i < first+coordinates.length/2; i++ )
+		links.push(i-1,i);
+	graph.connect_nodes(links);
+
 	document.insert(graph,"Insert Spiral");
 }
\ No newline at end of file
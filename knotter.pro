@@ -104,6 +104,17 @@ contains(CONFIG,c++11) {
     DEFINES += CXX_11
 }
 
+# qmake CONFIG+=no_trace removes trace scopes from the hot paths
+contains(CONFIG,no_trace) {
+    DEFINES += NO_TRACE
+}
+
+# qmake CONFIG+=startup_alloc_count replaces the global operator new to count
+# allocations in --profile-startup
+contains(CONFIG,startup_alloc_count) {
+    DEFINES += STARTUP_ALLOCATION_COUNT
+}
+
 
 #Extra make targets
 
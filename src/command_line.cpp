@@ -61,6 +61,15 @@ Command_Line::Command_Line(int argc, char *argv[])
         {
             ui = false;
         }
+        else if ( arg == "--profile-startup" )
+        {
+            // handled in main()
+        }
+        else if ( arg == "--trace" )
+        {
+            // handled in main()
+            i++;
+        }
         else if ( arg == "-a" || arg == "--antialias")
         {
             antialias = true;
@@ -115,6 +124,22 @@ Command_Line::Command_Line(int argc, char *argv[])
     }
 }
 
+bool Command_Line::profile_startup(int argc, char *argv[])
+{
+    for ( int i = 1; i < argc; i++ )
+        if ( qstrcmp(argv[i],"--profile-startup") == 0 )
+            return true;
+    return false;
+}
+
+QString Command_Line::trace_file(int argc, char *argv[])
+{
+    for ( int i = 1; i < argc-1; i++ )
+        if ( qstrcmp(argv[i],"--trace") == 0 )
+            return QString::fromLocal8Bit(argv[i+1]);
+    return QString();
+}
+
 void Command_Line::license() const
 {
     std::cout << "GNU General Public License version 3 or any later version." << std::endl;
@@ -153,6 +178,12 @@ void Command_Line::help() const
               << "Misc:\n"
               << "-b, --no-gui\n"
               << "\tDon't start the gui after parsing the command line.\n"
+              << "--profile-startup\n"
+              << "\tPrint time and allocations spent in each startup phase and exit.\n"
+              << "\tAllocations are counted only in builds with CONFIG+=startup_alloc_count.\n"
+              << "--trace file\n"
+              << "\tRecord a trace of the session and save it to file on exit.\n"
+              << "\tThe file can be opened with chrome://tracing or ui.perfetto.dev\n"
               << std::endl;
 
 
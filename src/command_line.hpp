@@ -40,6 +40,20 @@ class Command_Line
 public:
     Command_Line(int argc, char *argv[]);
 
+    /**
+     * \brief Whether \c --profile-startup has been passed
+     *
+     * Checked before everything else so the profile covers the whole startup
+     */
+    static bool profile_startup(int argc, char *argv[]);
+
+    /**
+     * \brief File passed to \c --trace or an empty string
+     *
+     * Checked before everything else so the trace covers the whole session
+     */
+    static QString trace_file(int argc, char *argv[]);
+
     QStringList files() const { return m_files; }
     bool load_ui() const { return ui; }
 
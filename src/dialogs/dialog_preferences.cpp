@@ -57,6 +57,9 @@ Dialog_Preferences::Dialog_Preferences(QMainWindow *parent) :
     check_cache_image->setChecked(resource_manager().settings.graph_cache());
     check_antialiasing->setChecked(resource_manager().settings.antialiasing());
     spin_timeout->setValue(resource_manager().settings.script_timeout());
+    spin_autosave->setValue(resource_manager().settings.autosave_interval());
+    spin_log_lines->setValue(resource_manager().settings.script_log_lines());
+    check_log_file->setChecked(resource_manager().settings.script_log_file());
 
     spin_recent_files->setValue(resource_manager().settings.max_recent_files());
     check_save_geometry->setChecked(resource_manager().settings.save_ui());
@@ -152,6 +155,9 @@ void Dialog_Preferences::set_preferences()
     resource_manager().settings.set_graph_cache(check_cache_image->isChecked());
     resource_manager().settings.set_antialiasing(check_antialiasing->isChecked());
     resource_manager().settings.set_script_timeout(spin_timeout->value());
+    resource_manager().settings.set_autosave_interval(spin_autosave->value());
+    resource_manager().settings.set_script_log_lines(spin_log_lines->value());
+    resource_manager().settings.set_script_log_file(check_log_file->isChecked());
 
     resource_manager().settings.set_max_recent_files(spin_recent_files->value());
     resource_manager().settings.set_save_ui(check_save_geometry->isChecked());
@@ -28,6 +28,7 @@ HEADERS += \
     $$PWD/dialog_plugins.hpp \
     $$PWD/dock/dock_borders.hpp \
     $$PWD/dock/dock_script_log.hpp \
+    $$PWD/dock/script_log_buffer.hpp \
     $$PWD/wizard_create_plugin.hpp \
     $$PWD/dock/dock_grid.hpp \
     $$PWD/dialog_edge_properties.hpp \
@@ -47,6 +48,7 @@ SOURCES += \
     $$PWD/dialog_plugins.cpp \
     $$PWD/dock/dock_borders.cpp \
     $$PWD/dock/dock_script_log.cpp \
+    $$PWD/dock/script_log_buffer.cpp \
     $$PWD/wizard_create_plugin.cpp \
     $$PWD/dialog_edge_properties.cpp \
     $$PWD/dock/dock_knot_style.cpp \
@@ -31,12 +31,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QShortcut>
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
 #include <QDesktopServices>
+#include "json_stuff.hpp"
+#include <QTextDocument>
+#include <QTextCursor>
 
 Dock_Script_Log::Dock_Script_Log(Main_Window *mw) :
-    QDockWidget(mw), target_window(mw), local_run(false), plugin(nullptr)
+    QDockWidget(mw), target_window(mw), local_run(false), plugin(nullptr),
+    log_file_failed(false)
 {
     setupUi(this);
+
+    log_timer.setSingleShot(true);
+    log_timer.setInterval(100);
+    connect(&log_timer,SIGNAL(timeout()),SLOT(flush_log()));
+    connect(button_clear_output,SIGNAL(clicked()),SLOT(clear_log()));
+
     connect(&resource_manager().script,SIGNAL(error(QString,int,QString,QStringList)),
             SLOT(script_error(QString,int,QString,QStringList)));
     connect(&resource_manager().script,SIGNAL(output(QString)),
@@ -72,6 +84,11 @@ Dock_Script_Log::Dock_Script_Log(Main_Window *mw) :
     connect(button_dialog,SIGNAL(toggled(bool)),SLOT(toggle_dialog(bool)));
     connect(button_external,SIGNAL(clicked()),SLOT(open_external_editor()));
     connect(button_reload,SIGNAL(clicked()),SLOT(deploy_plugin()));
+
+    connect(button_profile,SIGNAL(toggled(bool)),SLOT(toggle_profiler(bool)));
+    connect(button_profile_export,SIGNAL(clicked()),SLOT(export_profile()));
+    connect(&resource_manager().script,SIGNAL(running_script(bool)),
+            button_profile,SLOT(setDisabled(bool)));
 }
 
 void Dock_Script_Log::set_tool_button_style(Qt::ToolButtonStyle style)
@@ -114,9 +131,6 @@ QString Dock_Script_Log::escape_html(QString s)
 
 void Dock_Script_Log::script_error(QString file, int line, QString msg, QStringList trace)
 {
-    text_output->moveCursor (QTextCursor::End) ;
-
-
     QString file_html;
     if ( !local_run )
     {
@@ -133,29 +147,27 @@ void Dock_Script_Log::script_error(QString file, int line, QString msg, QStringL
     if ( line > 0 )
         line_html = QString(":%1:").arg(line);
 
-    text_output->insertHtml(
-        QString("<div>%1%2<span style='color:red'>%3</span>: %4<br/>%5</div>")
+    QString html = QString("<div>%1%2<span style='color:red'>%3</span>: %4<br/>%5</div>")
             .arg(file_html)
             .arg(line_html)
             .arg(tr("Error"))
             .arg(escape_html(msg))
-            .arg(trace.empty()?"":"Stack trace:")
-    );
+            .arg(trace.empty()?"":"Stack trace:");
+    QString plain = QString("%1%2 %3: %4").arg(file).arg(line_html).arg(tr("Error")).arg(msg);
+
     if ( !trace.empty() )
     {
-        QString trace_ul = "<ul style='margin-top:0; padding-top:0'>";
+        html += "<ul style='margin-top:0; padding-top:0'>";
 
         foreach ( QString s , trace )
         {
-            trace_ul += "<li>"+escape_html(s)+"</li>";
+            html += "<li>"+escape_html(s)+"</li>";
+            plain += "\n\t"+s;
         }
-        trace_ul += "</ul>";
-
-        text_output->insertHtml(trace_ul+"<p></p>");
+        html += "</ul><p></p>";
     }
 
-    text_output->moveCursor (QTextCursor::End) ;
-    text_output->ensureCursorVisible() ;
+    log(Script_Log_Buffer::HTML,html,plain);
 
     if ( local_run || file == filename )
     {
@@ -167,16 +179,121 @@ void Dock_Script_Log::script_error(QString file, int line, QString msg, QStringL
 
 void Dock_Script_Log::script_output(QString text)
 {
-    text_output->moveCursor (QTextCursor::End) ;
-    text_output->insertHtml("<pre>"+escape_html(text)+"</pre><p></p>");
+    log(Script_Log_Buffer::PLAIN_TEXT,text,text);
+}
+
+void Dock_Script_Log::log(Script_Log_Buffer::Kind kind, const QString &text,
+                          const QString &plain)
+{
+    if ( !resource_manager().settings.script_log_file() )
+    {
+        if ( log_file.isOpen() )
+            log_file.close();
+        log_file_failed = false;
+    }
+    else if ( !log_file_failed )
+    {
+        if ( !log_file.isOpen() )
+        {
+            log_file.setFileName(resource_manager().settings.script_log_file_name());
+            // The data directory may not exist yet on a fresh profile
+            if ( !QDir().mkpath(QFileInfo(log_file).absolutePath()) ||
+                 !log_file.open(QIODevice::WriteOnly|QIODevice::Append|QIODevice::Text) )
+            {
+                log_file_failed = true;
+                QString message = tr("Cannot write the log file \"%1\": %2")
+                                    .arg(log_file.fileName()).arg(log_file.errorString());
+                log_buffer.push(Script_Log_Buffer::HTML,
+                                "<div><span style='color:red'>"+tr("Error")+
+                                "</span>: "+escape_html(message)+"</div>");
+            }
+        }
+        if ( log_file.isOpen() )
+        {
+            log_file.write(plain.toUtf8());
+            log_file.write("\n");
+        }
+    }
+
+    log_buffer.set_capacity(resource_manager().settings.script_log_lines());
+    log_buffer.push(kind,text);
+
+    if ( !log_timer.isActive() )
+        log_timer.start();
+}
+
+void Dock_Script_Log::flush_log()
+{
+    log_timer.stop();
+    if ( log_file.isOpen() )
+        log_file.flush();
+
+    if ( log_buffer.empty() )
+        return;
+
+    int dropped = log_buffer.dropped();
+    QVector<Script_Log_Buffer::Entry> entries = log_buffer.take();
+
+    QTextCursor cursor(text_output->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+
+    QTextCharFormat plain_format;
+    plain_format.setFontFamily("monospace");
+    plain_format.setFontFixedPitch(true);
+
+    if ( dropped > 0 )
+    {
+        if ( !cursor.atBlockStart() )
+            cursor.insertBlock();
+        QTextCharFormat note_format;
+        note_format.setFontItalic(true);
+        cursor.insertText(tr("(%n message(s) discarded)","",dropped)+"\n",note_format);
+    }
+
+    QString text;
+    for ( int i = 0; i < entries.size(); i++ )
+    {
+        const Script_Log_Buffer::Entry& entry = entries[i];
+        if ( entry.kind == Script_Log_Buffer::PLAIN_TEXT )
+        {
+            // Plain text is collected and inserted without going through the HTML parser
+            text += entry.text;
+            text += '\n';
+            if ( i+1 < entries.size() && entries[i+1].kind == Script_Log_Buffer::PLAIN_TEXT )
+                continue;
+
+            if ( !cursor.atBlockStart() )
+                cursor.insertBlock();
+            cursor.insertText(text,plain_format);
+            text.clear();
+        }
+        else
+        {
+            cursor.insertHtml(entry.text);
+        }
+    }
+
+    cursor.endEditBlock();
+
+    // Keep the widget bounded as well, each plain text line is a block
+    text_output->document()->setMaximumBlockCount(
+        2*resource_manager().settings.script_log_lines());
+
     text_output->moveCursor (QTextCursor::End) ;
     text_output->ensureCursorVisible() ;
 }
 
+void Dock_Script_Log::clear_log()
+{
+    log_timer.stop();
+    log_buffer.clear();
+}
+
 void Dock_Script_Log::run_script(const QString &source, QString file_name,
                                  int line_number, bool echo)
 {
-
+    flush_log();
     text_output->moveCursor (QTextCursor::End) ;
 
     if ( echo )
@@ -187,12 +304,16 @@ void Dock_Script_Log::run_script(const QString &source, QString file_name,
     }
 
     Script_Window sw(target_window);
+    sw.set_deferred_render(true);
     resource_manager().script.param("window",&sw);
     resource_manager().script.param("document",sw.document());
 
 
     QScriptValue v = resource_manager().script.execute(source,file_name,line_number);
 
+    // Output printed by the script comes before its result
+    flush_log();
+    text_output->moveCursor (QTextCursor::End) ;
     if ( !v.isError() && !v.isUndefined() )
         text_output->insertHtml(escape_html(v.toString())+"<p></p>");
     text_output->moveCursor (QTextCursor::End) ;
@@ -366,3 +487,96 @@ void Dock_Script_Log::on_text_output_anchorClicked(const QUrl &arg1)
             source_editor->error_line( arg1.fragment().toInt() );
     }
 }
+
+void Dock_Script_Log::toggle_profiler(bool enable)
+{
+    resource_manager().script.enable_profiler(enable);
+    button_profile->setChecked(resource_manager().script.profiler().is_enabled());
+
+    if ( !enable )
+    {
+        button_profile_export->setEnabled(true);
+        show_profile();
+    }
+}
+
+void Dock_Script_Log::export_profile()
+{
+    QString file_name = QFileDialog::getSaveFileName(this,tr("Export Profile"),
+        QString(),"JSON Files (*.json);;All Files (*)");
+
+    if ( file_name.isEmpty() )
+        return;
+
+    QFile file(file_name);
+    if ( !file.open(QFile::Text|QFile::WriteOnly) )
+    {
+        script_error(file_name,0,tr("Cannot open file"));
+        return;
+    }
+    json_write_file(file,resource_manager().script.profiler().report());
+}
+
+void Dock_Script_Log::show_profile()
+{
+    const int max_rows = 10;
+
+    QVariantMap report = resource_manager().script.profiler().report();
+
+    QString html = "<div><span style='color:yellow'>"+tr("Profile")+"</span>";
+
+    html += "<table cellspacing='0' cellpadding='2'><tr><th>"+tr("Function")+"</th><th>"+
+            tr("Calls")+"</th><th>"+tr("Total (ms)")+"</th><th>"+tr("Self (ms)")+"</th></tr>";
+    QVariantList functions = report["functions"].toList();
+    for ( int i = 0; i < functions.size() && i < max_rows; i++ )
+    {
+        QVariantMap f = functions[i].toMap();
+        html += QString("<tr><td>%1 (%2:%3)</td><td>%4</td><td>%5</td><td>%6</td></tr>")
+                .arg(escape_html(f["function"].toString()))
+                .arg(escape_html(f["file"].toString()))
+                .arg(f["line"].toInt())
+                .arg(f["calls"].toLongLong())
+                .arg(f["total_ms"].toDouble(),0,'f',3)
+                .arg(f["self_ms"].toDouble(),0,'f',3);
+    }
+    html += "</table>";
+
+    html += "<table cellspacing='0' cellpadding='2'><tr><th>"+tr("Line")+"</th><th>"+
+            tr("Hits")+"</th><th>"+tr("Self (ms)")+"</th></tr>";
+    QVariantList lines = report["lines"].toList();
+    for ( int i = 0; i < lines.size() && i < max_rows; i++ )
+    {
+        QVariantMap l = lines[i].toMap();
+        html += QString("<tr><td>%1:%2</td><td>%3</td><td>%4</td></tr>")
+                .arg(escape_html(l["file"].toString()))
+                .arg(l["line"].toInt())
+                .arg(l["hits"].toLongLong())
+                .arg(l["self_ms"].toDouble(),0,'f',3);
+    }
+    html += "</table>";
+
+    QVariantList callbacks = report["callbacks"].toList();
+    if ( !callbacks.isEmpty() )
+    {
+        html += "<table cellspacing='0' cellpadding='2'><tr><th>"+tr("Plugin")+"</th><th>"+
+                tr("Calls")+"</th><th>"+tr("Per render")+"</th></tr>";
+        foreach ( const QVariant& item, callbacks )
+        {
+            QVariantMap c = item.toMap();
+            html += QString("<tr><td>%1 (%2)</td><td>%3</td><td>%4</td></tr>")
+                    .arg(escape_html(c["plugin"].toString()))
+                    .arg(c["callback"].toString())
+                    .arg(c["calls"].toLongLong())
+                    .arg(c["calls_per_render"].toDouble(),0,'f',1);
+        }
+        html += "</table>";
+    }
+
+    html += "</div><p></p>";
+
+    flush_log();
+    text_output->moveCursor (QTextCursor::End) ;
+    text_output->insertHtml(html);
+    text_output->moveCursor (QTextCursor::End) ;
+    text_output->ensureCursorVisible() ;
+}
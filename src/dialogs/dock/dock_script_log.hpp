@@ -30,6 +30,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ui_dock_script_log.h"
 #include "script_window.hpp"
 #include "plugin.hpp"
+#include "script_log_buffer.hpp"
+#include <QTimer>
+#include <QFile>
 
 class Dock_Script_Log : public QDockWidget, private Ui::Dock_Script_Log
 {
@@ -39,6 +42,10 @@ class Dock_Script_Log : public QDockWidget, private Ui::Dock_Script_Log
     bool          local_run;    ///< If is currently being executed code from the console itself
     QString       filename;     ///< Name of the open file
     Plugin*       plugin;       ///< The loaded plugin (if any)
+    Script_Log_Buffer log_buffer; ///< Messages waiting to be shown in text_output
+    QTimer        log_timer;    ///< Flushes log_buffer
+    QFile         log_file;     ///< Full log, when enabled in the settings
+    bool          log_file_failed; ///< log_file couldn't be opened, not retried until disabled
 public:
     explicit Dock_Script_Log(Main_Window* mw);
 
@@ -58,11 +65,32 @@ private:
 
     void save_file(QString file_name);
 
+    /**
+     * \brief Show a summary of the profiler results in the output
+     */
+    void show_profile();
+
+    /**
+     * \brief Queue a message for text_output
+     * \param kind  Format of \p text
+     * \param text  Message to display
+     * \param plain Plain text version of the message, written to the log file
+     */
+    void log(Script_Log_Buffer::Kind kind, const QString& text, const QString& plain);
+
 
 private slots:
     void unload_plugin();
     void script_error(QString file,int line,QString msg, QStringList trace = QStringList());
     void script_output(QString text);
+    /**
+     * \brief Show queued messages in text_output
+     *
+     * Consecutive plain text messages are inserted at once, lines dropped
+     * from the buffer are summarized.
+     */
+    void flush_log();
+    void clear_log();
     void run_script(const QString &source, QString file_name, int line_number, bool echo);
     void on_button_run_clicked();
     void editor_resized(QSize sz);
@@ -77,6 +105,8 @@ private slots:
      */
     void deploy_plugin();
     void on_text_output_anchorClicked(const QUrl &arg1);
+    void toggle_profiler(bool enable);
+    void export_profile();
 };
 
 #endif // DOCK_SCRIPT_LOG_HPP
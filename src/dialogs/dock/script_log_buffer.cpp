@@ -0,0 +1,89 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "script_log_buffer.hpp"
+
+Script_Log_Buffer::Script_Log_Buffer(int capacity)
+    : ring(qMax(1,capacity)), head(0), count(0), m_dropped(0)
+{
+}
+
+void Script_Log_Buffer::set_capacity(int capacity)
+{
+    capacity = qMax(1,capacity);
+    if ( capacity == ring.size() )
+        return;
+
+    int lost = m_dropped;
+    QVector<Entry> entries = take();
+    if ( entries.size() > capacity )
+    {
+        lost += entries.size() - capacity;
+        entries.remove(0,entries.size() - capacity);
+    }
+
+    ring = QVector<Entry>(capacity);
+    foreach ( const Entry& e, entries )
+        push(e.kind,e.text);
+    m_dropped = lost;
+}
+
+void Script_Log_Buffer::push(Kind kind, const QString &text)
+{
+    int size = ring.size();
+    if ( count < size )
+    {
+        ring[(head+count)%size] = Entry(kind,text);
+        count++;
+    }
+    else
+    {
+        ring[head] = Entry(kind,text);
+        head = (head+1)%size;
+        m_dropped++;
+    }
+}
+
+QVector<Script_Log_Buffer::Entry> Script_Log_Buffer::take()
+{
+    QVector<Entry> entries;
+    entries.reserve(count);
+    for ( int i = 0; i < count; i++ )
+    {
+        Entry& e = ring[(head+i)%ring.size()];
+        entries.push_back(e);
+        e.text = QString(); // release the memory
+    }
+    head = 0;
+    count = 0;
+    m_dropped = 0;
+    return entries;
+}
+
+void Script_Log_Buffer::clear()
+{
+    take();
+}
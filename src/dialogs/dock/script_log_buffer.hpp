@@ -0,0 +1,89 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SCRIPT_LOG_BUFFER_HPP
+#define SCRIPT_LOG_BUFFER_HPP
+
+#include <QVector>
+#include <QString>
+
+/**
+ * \brief Bounded FIFO of script log entries
+ *
+ * When full, the oldest entries are overwritten and counted as dropped.
+ */
+class Script_Log_Buffer
+{
+public:
+    enum Kind
+    {
+        PLAIN_TEXT, ///< Script output
+        HTML        ///< Formatted message, such as errors
+    };
+
+    struct Entry
+    {
+        Kind    kind;
+        QString text;
+
+        Entry(Kind kind = PLAIN_TEXT, const QString& text = QString())
+            : kind(kind), text(text) {}
+    };
+
+private:
+    QVector<Entry>  ring;
+    int             head;       ///< Index of the oldest entry
+    int             count;
+    int             m_dropped;  ///< Entries overwritten since the last take()
+
+public:
+    explicit Script_Log_Buffer(int capacity = 1000);
+
+    int capacity() const { return ring.size(); }
+    /**
+     * \brief Change the maximum number of entries
+     *
+     * If the buffer holds more, the oldest ones are dropped
+     */
+    void set_capacity(int capacity);
+
+    bool empty() const { return count == 0; }
+    int  dropped() const { return m_dropped; }
+
+    void push(Kind kind, const QString& text);
+
+    /**
+     * \brief Remove all the entries
+     * \return The entries, oldest first
+     * \post empty() and dropped() == 0
+     */
+    QVector<Entry> take();
+
+    /// Discard all the entries
+    void clear();
+};
+
+#endif // SCRIPT_LOG_BUFFER_HPP
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "main_window.hpp"
 #include "resource_manager.hpp"
+#include "graph_algorithms.hpp"
 #include <QMessageBox>
 #include "dialog_preferences.hpp"
 #include <QDockWidget>
@@ -43,34 +44,57 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPageSetupDialog>
 #include <QPrintPreviewDialog>
 #include "dialog_confirm_close.hpp"
+#include "startup_profile.hpp"
+#include "trace.hpp"
 #include <limits>
 
 Main_Window::Main_Window(QWidget *parent) :
     QMainWindow(parent), zoomer(nullptr), view(nullptr),
     dialog_export_image(this), about_dialog(this),
-    dialog_plugins(this)
+    dialog_plugins(this), open_loaded(0), open_progress(nullptr)
 {
-    setupUi(this);
-    setWindowIcon(QIcon(resource_manager().program.data("img/icon-small.svg")));
+    {
+        Startup_Timer timer("UI");
+        setupUi(this);
+        setWindowIcon(QIcon(resource_manager().program.data("img/icon-small.svg")));
+
+        setWindowTitle(resource_manager().program.name());
 
-    setWindowTitle(resource_manager().program.name());
+        init_statusbar();
+    }
 
-    init_statusbar();
-    init_docks();
+    {
+        Startup_Timer timer("Docks");
+        init_docks();
+    }
 
-    create_tab();
+    {
+        Startup_Timer timer("Empty tab");
+        create_tab();
+    }
 
-    init_menus();
+    {
+        Startup_Timer timer("Menus");
+        init_menus();
+    }
 
-    load_config();
+    {
+        Startup_Timer timer("Configuration");
+        load_config();
+    }
 
-    // init_toolbars must come load_config in order to configure properly user-defined toolbars
-    init_toolbars();
+    {
+        Startup_Timer timer("Toolbars");
+        // init_toolbars must come load_config in order to configure properly user-defined toolbars
+        init_toolbars();
+    }
 
 
     connect(Resource_Manager::pointer(),SIGNAL(language_changed()),this,SLOT(retranslate()));
     connect(this,SIGNAL(destroyed()),&resource_manager().script,SLOT(abort_script()));
     connect(&resource_manager().script,SIGNAL(plugins_changed()),SLOT(update_plugin_menu()));
+    connect(&autosave_timer,SIGNAL(timeout()),SLOT(autosave_snapshot()));
+    update_autosave_timer();
 
     foreach(Plugin* p, resource_manager().script.plugins())
     {
@@ -116,6 +140,8 @@ void Main_Window::init_menus()
 
     action_Zoom_In->setShortcut(QKeySequence::ZoomIn);
     action_Zoom_Out->setShortcut(QKeySequence::ZoomOut);
+    // --trace may have already started recording
+    action_Record_Trace->setChecked(Trace::recording());
 
     // Menu Nodes
     QActionGroup* transform_mode = new QActionGroup(this);
@@ -445,6 +471,7 @@ void Main_Window::connect_view(Knot_View *v)
 
     // modes
     v->set_display_graph(action_Display_Graph->isChecked());
+    v->set_show_render_stats(action_Render_Statistics->isChecked());
     action_Rotate->setChecked(v->transform_mode() == Transform_Handle::ROTATE);
     action_Scale->setChecked(v->transform_mode() == Transform_Handle::SCALE);
 
@@ -625,17 +652,26 @@ void Main_Window::on_action_Preferences_triggered()
     view->enable_cache(resource_manager().settings.graph_cache());
     view->set_antialiasing(resource_manager().settings.antialiasing());
     update_recent_files();
+    update_autosave_timer();
 }
 
 
 bool Main_Window::create_tab(QString file)
+{
+    return add_tab(file,nullptr);
+}
+
+bool Main_Window::add_tab(QString file, const Graph *loaded)
 {
     bool error = false;
     if ( view && view->file_name().isEmpty() &&
              !view->undo_stack_pointer()->canUndo() &&
              !view->undo_stack_pointer()->canRedo() )
     {
-        error = !view->load_file(file);
+        if ( loaded )
+            view->load_file(*loaded,file);
+        else
+            error = !view->load_file(file);
         if ( !error )
         {
             dock_knot_style->blockSignals(true);
@@ -668,7 +704,10 @@ bool Main_Window::create_tab(QString file)
         if ( view != nullptr )
             resource_manager().settings.set_knot_style(view->graph());
         Knot_View *v = new Knot_View();
-        error = !v->load_file(file);
+        if ( loaded )
+            v->load_file(*loaded,file);
+        else
+            error = !v->load_file(file);
         int t = tabWidget->addTab(v,file.isEmpty() ? tr("New Knot") : file);
         undo_group.addStack(v->undo_stack_pointer());
         if ( t != tabWidget->currentIndex() )
@@ -695,6 +734,155 @@ bool Main_Window::create_tab(QString file)
     return true;
 }
 
+void Main_Window::open_files(QStringList files)
+{
+    if ( files.empty() )
+        return;
+
+    if ( !open_progress )
+    {
+        open_progress = new QProgressDialog(this);
+        open_progress->setWindowTitle(tr("Open Knot"));
+        open_progress->setMinimumDuration(500);
+        open_progress->setAutoClose(false);
+        open_progress->setAutoReset(false);
+        connect(open_progress,SIGNAL(canceled()),SLOT(cancel_open_files()));
+    }
+
+    if ( open_queue.empty() )
+    {
+        open_loaded = 0;
+        open_progress->reset();
+    }
+
+    foreach ( QString file, files )
+    {
+        Knot_Loader* loader = new Knot_Loader(file,this);
+        connect(loader,SIGNAL(finished()),SLOT(file_loaded()));
+        open_queue.push_back(loader);
+        loader->start();
+    }
+
+    open_progress->setMaximum(open_loaded+open_queue.size());
+    open_progress->setLabelText(tr("Loading \"%1\"").arg(open_queue.front()->file_name()));
+    open_progress->setValue(open_loaded);
+}
+
+void Main_Window::file_loaded()
+{
+    Knot_Loader* loader = qobject_cast<Knot_Loader*>(sender());
+    if ( loader )
+        open_finished.insert(loader);
+
+    while ( !open_queue.empty() && open_finished.contains(open_queue.front()) )
+    {
+        Knot_Loader* ready = open_queue.takeFirst();
+        open_finished.remove(ready);
+        ready->wait();
+        open_loaded++;
+
+        // cancelled loaders are just discarded
+        if ( !ready->cancelled() )
+        {
+            if ( ready->success() )
+            {
+                add_tab(ready->file_name(),&ready->graph());
+                ready->release_graph();
+            }
+            else
+            {
+                QMessageBox::warning(this,tr("File Error"),
+                    tr("Error while reading \"%1\".").arg(ready->file_name()));
+            }
+        }
+
+        ready->deleteLater();
+    }
+
+    if ( open_queue.empty() )
+        open_progress->reset();
+    else if ( !open_progress->wasCanceled() )
+    {
+        open_progress->setLabelText(tr("Loading \"%1\"").arg(open_queue.front()->file_name()));
+        open_progress->setValue(open_loaded);
+    }
+}
+
+void Main_Window::cancel_open_files()
+{
+    foreach ( Knot_Loader* loader, open_queue )
+        loader->cancel();
+}
+
+void Main_Window::recover_files()
+{
+    QStringList files = Autosave::recovery_files();
+    if ( files.empty() )
+        return;
+
+    int r = QMessageBox::question(this,tr("Recover Files"),
+            tr("%n file(s) from a previous session have not been saved.\n"
+               "Do you want to recover them?","",files.size()),
+            QMessageBox::Yes|QMessageBox::No
+            );
+
+    foreach ( QString file, files )
+    {
+        // Snapshots that can't be read are kept so they aren't lost
+        if ( r != QMessageBox::Yes || recover_tab(file,Autosave::original_file(file)) )
+            Autosave::remove_recovery_file(file);
+    }
+}
+
+bool Main_Window::recover_tab(QString recovery_file, QString original_file)
+{
+    Knot_View *v = new Knot_View();
+    if ( !v->recover_file(recovery_file,original_file) )
+    {
+        delete v;
+        QMessageBox::warning(this,tr("File Error"),
+                             tr("Error while reading \"%1\".\n"
+                                "The file has been kept and can be recovered manually.")
+                                .arg(recovery_file));
+        return false;
+    }
+
+    int t = tabWidget->addTab(v,original_file.isEmpty() ? tr("New Knot") : original_file);
+    undo_group.addStack(v->undo_stack_pointer());
+    switch_to_tab(t);
+
+    view->grid().set_shape(resource_manager().settings.grid_shape());
+    view->grid().set_size(resource_manager().settings.grid_size());
+    view->grid().enable(resource_manager().settings.grid_enabled());
+
+    return true;
+}
+
+void Main_Window::update_autosave_timer()
+{
+    int minutes = resource_manager().settings.autosave_interval();
+    if ( minutes > 0 )
+        autosave_timer.start(minutes*60*1000);
+    else
+        autosave_timer.stop();
+}
+
+void Main_Window::autosave_snapshot()
+{
+    for ( int i = 0; i < tabWidget->count(); i++ )
+    {
+        Knot_View* kv = qobject_cast<Knot_View*>(tabWidget->widget(i));
+        if ( !kv )
+            continue;
+
+        // Unchanged documents are skipped
+        if ( kv->undo_stack_pointer()->isClean() )
+            autosave.discard(kv);
+        else
+            autosave.store(kv,kv->graph(),kv->file_name(),kv->revision());
+    }
+}
+
 void Main_Window::switch_to_tab(int i)
 {
     tabWidget->setCurrentIndex(i);
@@ -731,7 +919,9 @@ void Main_Window::close_tab(int i, bool confirm_if_changed)
         }
 
 
+        resource_manager().script.stop_workers(kv);
         undo_group.removeStack(kv->undo_stack_pointer());
+        autosave.discard(kv);
 
         emit tab_closing(kv);
 
@@ -796,8 +986,7 @@ void Main_Window::on_action_Open_triggered()
                 view->file_name(),
                 "Knot files (*.knot);;XML files (*.xml);;All files (*)" );
 
-    foreach ( QString file, files )
-        create_tab(file);
+    open_files(files);
 }
 
 void Main_Window::on_action_Save_triggered()
@@ -887,7 +1076,7 @@ void Main_Window::click_recent_file()
 
     QAction*a = qobject_cast<QAction*>(sender());
     if ( a )
-        create_tab(a->text());
+        open_files(QStringList() << a->text());
 }
 
 void Main_Window::update_plugin_menu()
@@ -968,21 +1157,8 @@ void Main_Window::on_action_Select_All_triggered()
 
 void Main_Window::on_actionSelect_Connected_triggered()
 {
-    QList<Node*> nodes = view->selected_nodes();
-    while ( !nodes.empty() )
-    {
-        Node* n1 = nodes.front();
-        nodes.pop_front();
-        foreach(Edge* e, n1->edges() )
-        {
-            Node* n2 = e->other(n1);
-            if ( !n2->isSelected() )
-            {
-                n2->setSelected(true);
-                nodes.push_back(n2);
-            }
-        }
-    }
+    foreach(Node* n, connected_nodes(view->selected_nodes()) )
+        n->setSelected(true);
     view->update_selection();
 }
 
@@ -994,9 +1170,40 @@ void Main_Window::on_action_Display_Graph_toggled(bool checked)
     view->set_display_graph(checked);
 }
 
+void Main_Window::on_action_Render_Statistics_toggled(bool checked)
+{
+    view->set_show_render_stats(checked);
+}
+
+void Main_Window::on_action_Record_Trace_toggled(bool checked)
+{
+    if ( checked )
+    {
+        if ( !Trace::recording() )
+            Trace::instance().start();
+        return;
+    }
+
+    Trace::instance().stop();
+
+    QString file = QFileDialog::getSaveFileName(this,tr("Save Trace"),
+                "knotter-trace.json", tr("Trace files (*.json);;All files (*)") );
+    if ( file.isEmpty() )
+        return;
+
+    if ( !Trace::instance().save(file) )
+        QMessageBox::warning(this,tr("File Error"),
+                tr("Failed to save file \"%1\".").arg(file) );
+}
+
 void Main_Window::on_action_Copy_triggered()
 {
-    Graph copy = view->graph().sub_graph(view->selected_nodes());
+    Graph copy = view->graph().sub_graph(view->selected_nodes(),false);
+    // paths are only needed by the image formats
+    if ( resource_manager().settings.clipboard_feature(Settings::SVG) ||
+         resource_manager().settings.clipboard_feature(Settings::PNG) ||
+         resource_manager().settings.clipboard_feature(Settings::TIFF) )
+        copy.render_knot();
     QMimeData* mime_data = new QMimeData;
     export_xml_mime_data(mime_data,copy);
     QApplication::clipboard()->setMimeData(mime_data);
@@ -1038,10 +1245,7 @@ void Main_Window::on_action_Paste_triggered()
 void Main_Window::on_action_Cut_triggered()
 {
     on_action_Copy_triggered();
-    view->begin_macro(tr("Cut"));
-    foreach(Node*n, view->selected_nodes() )
-        view->remove_node(n);
-    view->end_macro();
+    view->remove_nodes(view->selected_nodes(),tr("Cut"));
 }
 
 
@@ -1073,15 +1277,17 @@ void Main_Window::dropEvent(QDropEvent *event)
 {
     if ( event->mimeData()->hasUrls() )
     {
+        QStringList files;
         foreach ( QUrl url, event->mimeData()->urls() )
         {
 #if HAS_QT_4_8
             if ( url.isLocalFile() )
 #endif
             {
-                create_tab(url.toLocalFile());
+                files << url.toLocalFile();
             }
         }
+        open_files(files);
     }
     if ( event->mimeData()->hasFormat("application/x-knotter") )
     {
@@ -1101,6 +1307,8 @@ void Main_Window::closeEvent(QCloseEvent * ev)
         return;
     }
 
+    autosave_timer.stop();
+    autosave.discard_all();
     resource_manager().settings.save_window(this);
     resource_manager().settings.set_knot_style(view->graph());
     QMainWindow::closeEvent(ev);
@@ -1122,12 +1330,7 @@ void Main_Window::on_action_Erase_triggered()
 {
     QList<Node*> nodes = view->selected_nodes();
     if ( !nodes.empty() )
-    {
-        view->begin_macro(tr("Delete"));
-        foreach(Node*n, nodes )
-            view->remove_node(n);
-        view->end_macro();
-    }
+        view->remove_nodes(nodes,tr("Delete"));
 }
 
 void Main_Window::on_action_Close_triggered()
@@ -1227,26 +1430,17 @@ void Main_Window::on_action_Merge_triggered()
 
     view->begin_macro(tr("Merge Nodes"));
 
-    QPointF pos;
-    QList<Node*> outlinks;
-    QList<Edge_Type*> outlinks_styles;
+    Node_Contraction merged = contract_nodes(nodes);
 
-    for(QList<Node*>::iterator i = nodes.begin(); i != nodes.end(); i++)
-    {
-        pos += (*i)->pos() / nodes.size();
-        foreach(Edge* e, (*i)->edges() )
-            if ( !nodes.contains(e->other(*i)) && !outlinks.contains(e->other(*i)) )
-            {
-                outlinks.push_back(e->other(*i));
-                outlinks_styles.push_back(e->style().edge_type);
-            }
-        view->remove_node(*i);
-    }
+    foreach(Edge* e, merged.removed_edges)
+        view->remove_edge(e);
+    foreach(Node* n, nodes)
+        view->push_command(new Remove_Node(n,view));
 
-    Node* newn = view->add_node(pos);
-    for(int i = 0; i < outlinks.size(); i++ )
+    Node* newn = view->add_node(merged.pos);
+    for(int i = 0; i < merged.outlinks.size(); i++ )
         view->push_command(new Create_Edge(
-                        new Edge(newn,outlinks[i],outlinks_styles[i]),view));
+                        new Edge(newn,merged.outlinks[i],merged.outlink_types[i]),view));
 
     view->end_macro();
 }
@@ -44,6 +44,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "crossing_style_widget.hpp"
 #include "dock_knot_style.hpp"
 #include "dialog_preferences.hpp"
+#include "autosave.hpp"
+#include "knot_loader.hpp"
+#include <QTimer>
+#include <QProgressDialog>
+#include <QSet>
 
 class Main_Window : public QMainWindow, private Ui::Main_Window
 {
@@ -69,6 +74,12 @@ private:
     Dock_Script_Log*        dock_script_log;
     Crossing_Style_Widget*  widget_edge_style;
     QDoubleSpinBox*         scene_widgets[4];
+    Autosave                autosave;   ///< Crash recovery snapshots
+    QTimer                  autosave_timer;
+    QList<Knot_Loader*>     open_queue;     ///< Files being loaded, in the order they were requested
+    QSet<Knot_Loader*>      open_finished;  ///< Loaders in open_queue which have finished
+    int                     open_loaded;    ///< Number of files processed in the current batch
+    QProgressDialog*        open_progress;
 
 public:
     explicit Main_Window(QWidget *parent = 0);
@@ -80,6 +91,9 @@ public:
      */
     Knot_View* view_at(int n);
 
+    /// Whether some files passed to open_files() are still being loaded
+    bool loading_files() const { return !open_queue.empty(); }
+
 public slots:
     /// Change all the strings to their translated version
     void retranslate();
@@ -93,6 +107,14 @@ public slots:
      */
     bool create_tab(QString file = QString());
 
+    /**
+     * \brief Load files in the background and open them in new tabs
+     *
+     * Files are loaded concurrently, tabs are created in the same order
+     * as \p files as soon as they are ready.
+     */
+    void open_files(QStringList files);
+
     /**
      *  \brief Switch to the gien tab
      *  \param i tab index
@@ -111,6 +133,11 @@ public slots:
 
     void print (QPrinter* pr);
 
+    /**
+     * \brief Offer to recover the files left behind by a crashed session
+     */
+    void recover_files();
+
 signals:
     /**
      * @brief Emitted whet a tab is about to be closed
@@ -134,6 +161,19 @@ private:
     void retranslate_docks();
     /// Load saved configuration
     void load_config();
+    /**
+     * \brief Create a tab for \p file
+     * \param loaded If not null, contents of the file already loaded
+     */
+    bool add_tab(QString file, const Graph* loaded);
+    /// Start or stop the autosave timer to match the settings
+    void update_autosave_timer();
+    /**
+     * \brief Open a recovery snapshot in a new tab
+     * \param original_file File the snapshot was taken from, may be empty
+     * \return Whether the snapshot could be read, errors are reported to the user
+     */
+    bool recover_tab(QString recovery_file, QString original_file);
 
     /**
      *  \brief Ensure view is connected to the proper signals/slots
@@ -152,6 +192,15 @@ private:
 
 private slots:
     void set_icon_size(int);
+    /**
+     *  \brief Write recovery snapshots of the modified files
+     */
+    void autosave_snapshot();
+    /**
+     *  \brief Attach the files loaded by open_files()
+     */
+    void file_loaded();
+    void cancel_open_files();
     /**
      *  \brief Toggle tab icon to show whether the file has been modified
     */
@@ -207,6 +256,8 @@ private slots:
 
     void on_action_Preferences_triggered();
     void on_action_Display_Graph_toggled(bool arg1);
+    void on_action_Render_Statistics_toggled(bool checked);
+    void on_action_Record_Trace_toggled(bool checked);
     void on_action_Zoom_In_triggered();
     void on_action_Zoom_Out_triggered();
     void on_action_Reset_Zoom_triggered();
@@ -36,15 +36,15 @@ QColor Edge::color_selected(128,128,128,128);
 
 Edge::Edge(Node *v1, Node *v2, Edge_Type *type) :
     v1(v1), v2(v2),
+    m_style(Edge_Style(24,10,0.5,type ? type : resource_manager().default_edge_type(),
+                       Edge_Style::EDGE_TYPE)),
     available_handles(TOP_LEFT|TOP_RIGHT|BOTTOM_LEFT|BOTTOM_RIGHT),
-    m_graph(nullptr)
+    m_graph(nullptr), v1_slot(-1), v2_slot(-1),
+    render_style(nullptr), render_handles(nullptr)
 {
     attach();
     setZValue(1);
     setFlag(QGraphicsItem::ItemIsSelectable);
-
-    m_style.enabled_style |= Edge_Style::EDGE_TYPE;
-    m_style.edge_type = type ? type : resource_manager().default_edge_type();
 }
 
 QRectF Edge::boundingRect() const
@@ -72,25 +72,25 @@ void Edge::attach()
 
 void Edge::set_style(Edge_Style st)
 {
+    st.enabled_style |= Edge_Style::EDGE_TYPE;
+    if ( !st.edge_type )
+        st.edge_type = resource_manager().default_edge_type();
     m_style = st;
-    m_style.enabled_style |= Edge_Style::EDGE_TYPE;
-    m_style.edge_type = st.edge_type ? st.edge_type :
-                                       resource_manager().default_edge_type();
-}
-
-Edge_Style Edge::style() const
-{
-    return m_style;
 }
 
-Edge_Style &Edge::style()
+QLineF Edge::handle(Handle handle) const
 {
-    return m_style;
+    int index = handle_index(handle);
+    if ( render_handles && index >= 0 )
+        return render_handles[index];
+    return m_style->edge_type->handle(this,handle);
 }
 
 Edge_Style Edge::defaulted_style() const
 {
-    return m_style.default_to(m_graph->default_edge_style());
+    if ( render_style )
+        return *render_style;
+    return m_style->default_to(m_graph->default_edge_style());
 }
 
 void Edge::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
@@ -107,9 +107,9 @@ void Edge::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
     }
 
     if ( visible && highlighted )
-        m_style.edge_type->paint_highlighted(painter,*this);
+        m_style->edge_type->paint_highlighted(painter,*this);
     else if ( visible || highlighted )
-        m_style.edge_type->paint_regular(painter,*this);
+        m_style->edge_type->paint_regular(painter,*this);
 
 }
 
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QLineF>
 #include "c++.hpp"
 #include "edge_style.hpp"
+#include "interned_style.hpp"
 
 class Edge : public Graph_Item
 {
@@ -60,9 +61,17 @@ public:
 private:
     Node* v1;
     Node* v2;
-    Edge_Style m_style;
+    Interned_Style<Edge_Style> m_style;
     Handle_Flags available_handles;
     const Graph* m_graph;
+    int v1_slot; ///< Index in v1->edges(), -1 if not attached
+    int v2_slot; ///< Index in v2->edges(), -1 if not attached
+    const Edge_Style* render_style;  ///< Resolved style in the arrays of the graph being rendered
+    const QLineF* render_handles;    ///< Four handles in the arrays of the graph being rendered
+
+    friend class Node;
+    /// Index of this edge in the edge list of \p n
+    int& adjacency_slot(const Node* n) { return n == v1 ? v1_slot : v2_slot; }
 
     static const int shapew = 8; ///< Width ued for shape()
 public:
@@ -110,15 +119,13 @@ public:
      * @brief Get the crossing style as defined by theis edge
      * @return The style overidden by this edge
      */
-    Edge_Style style() const;
-    /**
-     * @brief Get the crossing style as defined by theis edge
-     * @return The style overidden by this edge
-     */
-    Edge_Style& style();
+    const Edge_Style& style() const { return *m_style; }
 
     /**
      * @brief Defaulted edge style
+     *
+     * While the graph is being rendered this is the style it resolved
+     * for the render
      * @return The complete edge style, non-overridden features are taken from the graph
      */
     Edge_Style defaulted_style() const;
@@ -173,6 +180,42 @@ public:
             return NO_HANDLE;
     }
 
+    /// Index of \p handle in an array of the four handles, -1 for NO_HANDLE
+    static int handle_index(Handle handle)
+    {
+        switch ( handle )
+        {
+            case TOP_LEFT:      return 0;
+            case TOP_RIGHT:     return 1;
+            case BOTTOM_LEFT:   return 2;
+            case BOTTOM_RIGHT:  return 3;
+            default:            return -1;
+        }
+    }
+
+    /**
+     * \brief Get handle geometry
+     *
+     * Uses the values computed by the graph being rendered while they are
+     * available, otherwise asks the edge type.
+     */
+    QLineF handle(Handle handle) const;
+
+    /**
+     * \brief Use data computed by the graph for the current render
+     * \param style   Resolved style
+     * \param handles The four handles by handle_index(), may be \c nullptr
+     * \note The data is owned by the graph, positions and styles must not
+     *       change until clear_render_data()
+     */
+    void set_render_data(const Edge_Style* style, const QLineF* handles)
+    {
+        render_style = style;
+        render_handles = handles;
+    }
+
+    void clear_render_data() { set_render_data(nullptr,nullptr); }
+
     /// Get node in the direction of the handle
     Node* vertex_for(Handle handle) const
     {
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "edge_style.hpp"
+#include "point_math.hpp"
 
 Edge_Style Edge_Style::default_to(const Edge_Style &other) const
 {
@@ -38,3 +39,9 @@ Edge_Style Edge_Style::default_to(const Edge_Style &other) const
 
 }
 
+uint qHash(const Edge_Style &style)
+{
+    return uint(style.enabled_style) ^ hash_double(style.handle_length) ^
+           (hash_double(style.crossing_distance) << 1) ^
+           (hash_double(style.edge_slide) << 2) ^ qHash(style.edge_type);
+}
@@ -77,9 +77,20 @@ public:
     /// Set disabled style to the values in other
     Edge_Style default_to(const Edge_Style& other) const;
 
+    bool operator== (const Edge_Style& o) const
+    {
+        return enabled_style == o.enabled_style && handle_length == o.handle_length &&
+               crossing_distance == o.crossing_distance && edge_slide == o.edge_slide &&
+               edge_type == o.edge_type;
+    }
+
+    bool operator!= (const Edge_Style& o) const { return !(*this == o); }
+
 
 };
 
+uint qHash(const Edge_Style& style);
+
 Q_DECLARE_METATYPE(Edge_Style::Enabled_Styles)
 
 #endif // EDGE_STYLE_HPP
@@ -31,6 +31,64 @@ Edge_Type::Edge_Type()
 {
 }
 
+/**
+ * \brief Crossing point and direction of an edge
+ *
+ * Directions are expressed as (cos,sin) pairs of angles as returned by
+ * QLineF::angle(), so no trigonometry is needed to build the handles.
+ */
+class Edge_Frame
+{
+    QPointF mid;
+    double  half_gap;
+    double  handle_length;
+
+public:
+    double  c; ///< Cosine of the edge angle
+    double  s; ///< Sine of the edge angle
+
+    explicit Edge_Frame(const Edge* edge)
+    {
+        const Edge_Style& style = edge->defaulted_style();
+        QLineF line = edge->to_line();
+        mid = line.pointAt(style.edge_slide);
+        half_gap = style.crossing_distance/2;
+        handle_length = style.handle_length;
+
+        double length = line.length();
+        if ( length > 0 )
+        {
+            c = line.dx()/length;
+            s = -line.dy()/length;
+        }
+        else
+        {
+            c = 1;
+            s = 0;
+        }
+    }
+
+    /**
+     * \brief Build a handle
+     * \param offset    Direction from the crossing point to the path point
+     * \param direction Direction from the path point to the control point
+     */
+    QLineF handle(QPointF offset, QPointF direction) const
+    {
+        QPointF p1(mid.x()+half_gap*offset.x(), mid.y()-half_gap*offset.y());
+        QPointF p2(p1.x()+handle_length*direction.x(), p1.y()-handle_length*direction.y());
+        return QLineF(p1,p2);
+    }
+};
+
+void Edge_Type::handles(const Edge *edge, QLineF out[]) const
+{
+    out[Edge::handle_index(Edge::TOP_LEFT)] = handle(edge,Edge::TOP_LEFT);
+    out[Edge::handle_index(Edge::TOP_RIGHT)] = handle(edge,Edge::TOP_RIGHT);
+    out[Edge::handle_index(Edge::BOTTOM_LEFT)] = handle(edge,Edge::BOTTOM_LEFT);
+    out[Edge::handle_index(Edge::BOTTOM_RIGHT)] = handle(edge,Edge::BOTTOM_RIGHT);
+}
+
 void Edge_Type::paint_regular(QPainter *painter, const Edge &edge)
 {
     QPen pen(Edge::color_resting,2);
@@ -56,29 +114,36 @@ void Edge_Type::paint(QPainter *painter, const Edge &edge)
 
 QLineF Edge_Normal::handle(const Edge *edge, Edge::Handle handle) const
 {
+    if ( Edge::handle_index(handle) < 0 )
+        return QLineF();
 
-    Edge_Style style = edge->defaulted_style();
+    Edge_Frame frame(edge);
+    const double r = 0.70710678118654752440; // sqrt(1/2)
 
-    long double handle_angle = 0;
-    if ( handle == Edge::TOP_RIGHT )
-        handle_angle = pi()/4.0;
-    else if ( handle == Edge::TOP_LEFT )
-        handle_angle = pi()*3.0/4.0;
-    else if ( handle == Edge::BOTTOM_LEFT )
-        handle_angle = pi()*5.0/4.0;
-    else if ( handle == Edge::BOTTOM_RIGHT )
-        handle_angle = pi()*7.0/4.0;
+    QPointF direction;
+    if ( handle == Edge::TOP_RIGHT || handle == Edge::BOTTOM_LEFT )
+        direction = QPointF(r*(frame.c-frame.s), r*(frame.s+frame.c));
+    else
+        direction = QPointF(-r*(frame.c+frame.s), r*(frame.c-frame.s));
+    if ( handle == Edge::BOTTOM_LEFT || handle == Edge::BOTTOM_RIGHT )
+        direction = -direction;
 
-    handle_angle += deg2rad(edge->to_line().angle());
-    QPointF p1 = edge->to_line().pointAt(style.edge_slide);
-    p1.setX(p1.x()+style.crossing_distance/2*qCos(handle_angle));
-    p1.setY(p1.y()-style.crossing_distance/2*qSin(handle_angle));
+    return frame.handle(direction,direction);
+}
+
+void Edge_Normal::handles(const Edge *edge, QLineF out[]) const
+{
+    Edge_Frame frame(edge);
+    const double r = 0.70710678118654752440; // sqrt(1/2)
 
-    QPointF p2;
-    p2.setX(p1.x()+style.handle_length*qCos(handle_angle));
-    p2.setY(p1.y()-style.handle_length*qSin(handle_angle));
+    // edge angle + 45 and + 135 degrees
+    QPointF top_right(r*(frame.c-frame.s), r*(frame.s+frame.c));
+    QPointF top_left(-r*(frame.c+frame.s), r*(frame.c-frame.s));
 
-    return QLineF(p1,p2);
+    out[Edge::handle_index(Edge::TOP_RIGHT)] = frame.handle(top_right,top_right);
+    out[Edge::handle_index(Edge::TOP_LEFT)] = frame.handle(top_left,top_left);
+    out[Edge::handle_index(Edge::BOTTOM_LEFT)] = frame.handle(-top_right,-top_right);
+    out[Edge::handle_index(Edge::BOTTOM_RIGHT)] = frame.handle(-top_left,-top_left);
 }
 
 
@@ -99,8 +164,8 @@ Edge::Handle Edge_Normal::traverse(Edge *edge, Edge::Handle hand,
 
 
    if ( hand == Edge::TOP_LEFT || next == Edge::TOP_LEFT )
-       path.add_line(handle(edge,hand).p1(),
-                     handle(edge,next).p1()
+       path.add_line(edge->handle(hand).p1(),
+                     edge->handle(next).p1()
                      );
 
    return next ;
@@ -154,8 +219,8 @@ Edge::Handle Edge_Inverted::traverse(Edge *edge, Edge::Handle hand,
 
 
    if ( hand == Edge::TOP_RIGHT || next == Edge::TOP_RIGHT )
-       path.add_line(handle(edge,hand).p1(),
-                     handle(edge,next).p1()
+       path.add_line(edge->handle(hand).p1(),
+                     edge->handle(next).p1()
                      );
 
    return next ;
@@ -196,8 +261,8 @@ Edge::Handle Edge_Wall::traverse(Edge *edge, Edge::Handle hand,
     Q_UNUSED(path);
     Q_UNUSED(default_style);*/
 
-    QLineF h1 = handle(edge,hand);
-    QLineF h2 = handle(edge,next);
+    QLineF h1 = edge->handle(hand);
+    QLineF h2 = edge->handle(next);
     if ( !qFuzzyCompare(h1.p1(),h2.p1()) )
     {
         path.add_line(h1.p1(),h2.p1());
@@ -219,45 +284,32 @@ QString Edge_Wall::machine_name() const
 
 QLineF Edge_Wall::handle(const Edge *edge, Edge::Handle handle) const
 {
+    if ( Edge::handle_index(handle) < 0 )
+        return QLineF();
 
-    Edge_Style style = edge->defaulted_style();
-
-    long double handle_angle = 0;
-    if ( handle == Edge::TOP_RIGHT || handle == Edge::TOP_LEFT )
-        handle_angle = pi()/2.0;
-    else
-        handle_angle = pi()*3.0/2.0;
+    Edge_Frame frame(edge);
 
-    long double edge_angle = deg2rad(edge->to_line().angle());
-    handle_angle += edge_angle;
-
-    QPointF p1 = edge->to_line().pointAt(style.edge_slide);
-    p1.setX(p1.x()+style.crossing_distance/2*qCos(handle_angle));
-    p1.setY(p1.y()-style.crossing_distance/2*qSin(handle_angle));
-
-
-    if ( handle == Edge::TOP_RIGHT || handle == Edge::BOTTOM_RIGHT )
-        handle_angle = 0;
-    else
-        handle_angle = pi();
-    handle_angle += edge_angle;
+    QPointF up(-frame.s,frame.c);
+    QPointF forward(frame.c,frame.s);
+    if ( handle == Edge::BOTTOM_LEFT || handle == Edge::BOTTOM_RIGHT )
+        up = -up;
+    if ( handle == Edge::TOP_LEFT || handle == Edge::BOTTOM_LEFT )
+        forward = -forward;
 
-    QPointF p2;
-    p2.setX(p1.x()+style.handle_length*qCos(handle_angle));
-    p2.setY(p1.y()-style.handle_length*qSin(handle_angle));
+    return frame.handle(up,forward);
+}
 
+void Edge_Wall::handles(const Edge *edge, QLineF out[]) const
+{
+    Edge_Frame frame(edge);
 
-    /*double cd1 = style.crossing_distance;
-    double cd2 = edge->other(edge->vertex_for(handle))->style()
-                    .default_to(default_style).crossing_distance;
-    if ( !qFuzzyCompare(cd1,cd2) )
-    {
-        p1 = p2;
-        p2.setX(p1.x()+style.handle_length*qCos(handle_angle));
-        p2.setY(p1.y()-style.handle_length*qSin(handle_angle));
-    }*/
+    QPointF up(-frame.s,frame.c);
+    QPointF forward(frame.c,frame.s);
 
-    return QLineF(p1,p2);
+    out[Edge::handle_index(Edge::TOP_RIGHT)] = frame.handle(up,forward);
+    out[Edge::handle_index(Edge::TOP_LEFT)] = frame.handle(up,-forward);
+    out[Edge::handle_index(Edge::BOTTOM_LEFT)] = frame.handle(-up,-forward);
+    out[Edge::handle_index(Edge::BOTTOM_RIGHT)] = frame.handle(-up,forward);
 }
 
 
@@ -273,32 +325,32 @@ QString Edge_Hole::machine_name() const
 
 QLineF Edge_Hole::handle(const Edge *edge, Edge::Handle handle) const
 {
-    Edge_Style style = edge->defaulted_style();
-
-    long double handle_angle = 0;
-    if ( handle == Edge::BOTTOM_LEFT || handle == Edge::TOP_LEFT )
-        handle_angle = pi();
+    if ( Edge::handle_index(handle) < 0 )
+        return QLineF();
 
-    long double edge_angle = deg2rad(edge->to_line().angle());
-    handle_angle += edge_angle;
+    Edge_Frame frame(edge);
 
-    QPointF p1 = edge->to_line().pointAt(style.edge_slide);
-    p1.setX(p1.x()+style.crossing_distance/2*qCos(handle_angle));
-    p1.setY(p1.y()-style.crossing_distance/2*qSin(handle_angle));
+    QPointF up(-frame.s,frame.c);
+    QPointF forward(frame.c,frame.s);
+    if ( handle == Edge::BOTTOM_LEFT || handle == Edge::BOTTOM_RIGHT )
+        up = -up;
+    if ( handle == Edge::TOP_LEFT || handle == Edge::BOTTOM_LEFT )
+        forward = -forward;
 
+    return frame.handle(forward,up);
+}
 
-    if ( handle == Edge::TOP_RIGHT || handle == Edge::TOP_LEFT )
-        handle_angle = pi()/2.0;
-    else
-        handle_angle = pi()*3.0/2.0;
-    handle_angle += edge_angle;
-
-    QPointF p2;
-    p2.setX(p1.x()+style.handle_length*qCos(handle_angle));
-    p2.setY(p1.y()-style.handle_length*qSin(handle_angle));
+void Edge_Hole::handles(const Edge *edge, QLineF out[]) const
+{
+    Edge_Frame frame(edge);
 
-    return QLineF(p1,p2);
+    QPointF up(-frame.s,frame.c);
+    QPointF forward(frame.c,frame.s);
 
+    out[Edge::handle_index(Edge::TOP_RIGHT)] = frame.handle(forward,up);
+    out[Edge::handle_index(Edge::TOP_LEFT)] = frame.handle(-forward,up);
+    out[Edge::handle_index(Edge::BOTTOM_LEFT)] = frame.handle(-forward,-up);
+    out[Edge::handle_index(Edge::BOTTOM_RIGHT)] = frame.handle(forward,-up);
 }
 
 
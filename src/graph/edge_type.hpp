@@ -58,6 +58,15 @@ public:
      */
     virtual QLineF handle(const Edge *edge, Edge::Handle handle) const = 0;
 
+    /**
+     *  \brief Get the geometry of all four handles
+     *
+     *  Called once per edge before rendering, the default implementation
+     *  calls handle() for each of them
+     *  \param out Handles indexed by Edge::handle_index()
+     */
+    virtual void handles(const Edge *edge, QLineF out[4]) const;
+
     /// (Translated) Human-readable name, used in the UI
     virtual QString name() const = 0;
 
@@ -82,6 +91,7 @@ public:
     QString name() const override;
     QString machine_name() const override;
     QLineF handle(const Edge *edge, Edge::Handle handle) const override;
+    void handles(const Edge *edge, QLineF out[4]) const override;
     QIcon icon() const override { return QIcon::fromTheme("edge-crossing"); }
 };
 
@@ -104,6 +114,7 @@ public:
     QString name() const override;
     QString machine_name() const override;
     QLineF handle(const Edge *edge, Edge::Handle handle) const override;
+    void handles(const Edge *edge, QLineF out[4]) const override;
     QIcon icon() const override { return QIcon::fromTheme("edge-wall"); }
 };
 
@@ -116,6 +127,7 @@ public:
     QString name() const override;
     QString machine_name() const override;
     QLineF handle(const Edge *edge, Edge::Handle handle) const override;
+    void handles(const Edge *edge, QLineF out[4]) const override;
     QIcon icon() const override { return QIcon::fromTheme("edge-hole"); }
 };
 
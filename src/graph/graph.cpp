@@ -27,6 +27,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "edge_type.hpp"
 #include "resource_manager.hpp"
 #include <QPaintEngine>
+#include <QSet>
+#include <QVector>
+#include "trace.hpp"
 
 Graph::Graph() :
     m_default_node_style(225,// cusp angle
@@ -42,6 +45,7 @@ Graph::Graph() :
                          resource_manager().default_edge_type(),
                          Edge_Style::EVERYTHING
                     ),
+    removed_nodes(0), removed_edges(0),
     auto_color(false), m_paint_border(true)
 {
     m_colors.push_back(Qt::black);
@@ -52,15 +56,25 @@ Graph::Graph() :
 }
 
 Graph::Graph(const Graph &other)
-    : QGraphicsItem()
+    : QGraphicsItem(), removed_nodes(0), removed_edges(0)
 {
     *this = other;
 }
 
+Graph::~Graph()
+{
+    // drop the script view used by scripted edge types
+    resource_manager().script.release_graph_wrapper(this);
+}
+
 Graph &Graph::operator= ( const Graph &o )
 {
+    o.compact();
     m_edges = o.m_edges;
     m_nodes = o.m_nodes;
+    node_slots = o.node_slots;
+    edge_slots = o.edge_slots;
+    removed_nodes = removed_edges = 0;
     bounding_box = o.bounding_box;
     paths = o.paths;
     border_width_cache = o.border_width_cache;
@@ -85,11 +99,13 @@ void Graph::copy_style(const Graph &other)
 
 void Graph::add_node(Node *n)
 {
+    node_slots[n] = m_nodes.size();
     m_nodes.append(n);
 }
 
 void Graph::add_edge(Edge *e)
 {
+    edge_slots[e] = m_edges.size();
     m_edges.append(e);
     e->attach();
     e->set_graph(this);
@@ -97,18 +113,76 @@ void Graph::add_edge(Edge *e)
 
 void Graph::remove_node(Node *n)
 {
-    m_nodes.removeOne(n);
+    QHash<const Node*,int>::iterator it = node_slots.find(n);
+    if ( it != node_slots.end() )
+    {
+        m_nodes[it.value()] = nullptr;
+        node_slots.erase(it);
+        removed_nodes++;
+    }
     //n->setParentItem(nullptr);
 }
 
 void Graph::remove_edge(Edge *e)
 {
-    m_edges.removeOne(e);
+    QHash<const Edge*,int>::iterator it = edge_slots.find(e);
+    if ( it != edge_slots.end() )
+    {
+        m_edges[it.value()] = nullptr;
+        edge_slots.erase(it);
+        removed_edges++;
+    }
     e->detach();
     e->set_graph(nullptr);
     //e->setParentItem(nullptr);
 }
 
+void Graph::compact_slots() const
+{
+    if ( removed_nodes )
+    {
+        QList<Node*> nodes;
+        nodes.reserve(m_nodes.size()-removed_nodes);
+        foreach ( Node* n, m_nodes )
+        {
+            if ( n )
+            {
+                node_slots[n] = nodes.size();
+                nodes.append(n);
+            }
+        }
+        qSwap(m_nodes,nodes);
+        removed_nodes = 0;
+    }
+
+    if ( removed_edges )
+    {
+        QList<Edge*> edges;
+        edges.reserve(m_edges.size()-removed_edges);
+        foreach ( Edge* e, m_edges )
+        {
+            if ( e )
+            {
+                edge_slots[e] = edges.size();
+                edges.append(e);
+            }
+        }
+        qSwap(m_edges,edges);
+        removed_edges = 0;
+    }
+}
+
+void Graph::reindex()
+{
+    node_slots.clear();
+    for ( int i = 0; i < m_nodes.size(); i++ )
+        node_slots[m_nodes[i]] = i;
+    edge_slots.clear();
+    for ( int i = 0; i < m_edges.size(); i++ )
+        edge_slots[m_edges[i]] = i;
+    removed_nodes = removed_edges = 0;
+}
+
 /*void Graph::clear()
 {
     foreach(Edge* e, m_edges)
@@ -177,6 +251,9 @@ void Graph::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWi
 
 void Graph::const_paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) const
 {
+    TRACE_SCOPE("Graph::const_paint");
+    QElapsedTimer timer;
+    timer.start();
 
     if ( ! m_colors.empty() )
     {
@@ -211,10 +288,13 @@ void Graph::const_paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWi
         }
 
     }
+
+    m_render_stats.paint = Render_Stats::nanoseconds(timer);
 }
 
 void Graph::paint_graph(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) const
 {
+    compact();
 
     foreach(Edge* e, m_edges)
         e->paint(painter,option,widget);
@@ -227,15 +307,32 @@ void Graph::paint_graph(QPainter *painter, const QStyleOptionGraphicsItem *optio
 }
 void Graph::render_knot()
 {
+    TRACE_SCOPE("Graph::render_knot");
+    resource_manager().script.profiler().mark_render();
     paths.clear();
+
+    QElapsedTimer timer;
+    timer.start();
     Path_Builder path;
     traverse(path);
+    m_render_stats.traverse = Render_Stats::nanoseconds(timer);
+
+    timer.restart();
     paths = path.build();
+    m_render_stats.path_build = Render_Stats::nanoseconds(timer);
+
+    timer.restart();
     update_bounding_box();
+    m_render_stats.bounding_box = Render_Stats::nanoseconds(timer);
+
+    m_render_stats.segments = path.segment_count();
+    m_render_stats.loops = paths.size();
+    m_render_stats.renders++;
+
     update();
 }
 
-Graph Graph::sub_graph(QList<Node *> nodes) const
+Graph Graph::sub_graph(QList<Node *> nodes, bool render) const
 {
     Graph graph(*this);
     graph.m_nodes.clear();
@@ -244,7 +341,10 @@ Graph Graph::sub_graph(QList<Node *> nodes) const
     graph.m_nodes.reserve(nodes.size());
     graph.m_edges.reserve(nodes.size());
 
-
+    QSet<const Node*> included;
+    included.reserve(nodes.size());
+    foreach ( Node* n, nodes )
+        included.insert(n);
 
     foreach ( Node* n, nodes )
     {
@@ -252,15 +352,15 @@ Graph Graph::sub_graph(QList<Node *> nodes) const
 
         foreach ( Edge* e, n->edges() )
         {
-            if ( nodes.contains(e->other(n)) &&
-                 !graph.m_edges.contains(e) )
-            {
+            // each edge is reached from both vertices, add it only once
+            if ( e->vertex1() == n && included.contains(e->vertex2()) )
                 graph.m_edges.push_back(e);
-            }
         }
     }
 
-    graph.render_knot();
+    graph.reindex();
+    if ( render )
+        graph.render_knot();
 
     return graph;
 
@@ -278,11 +378,28 @@ bool Graph::cache_enabled() const
 
 void Graph::traverse(Path_Builder &path)
 {
+    TRACE_SCOPE("Graph::traverse");
+    compact();
     QList<Edge*> traversed_edges;
     traversed_edges.reserve(m_edges.size());
 
-    for(QList<Edge*>::iterator i = m_edges.begin(); i != m_edges.end(); ++i)
-        (*i)->reset();
+    /*
+        Styles and handles are requested several times per edge, resolve them
+        in one pass into arrays parallel to m_edges.
+        They only live for the traversal so edges don't carry them around.
+    */
+    QVector<Edge_Style> styles(m_edges.size());
+    QVector<QLineF> handles(m_edges.size()*4);
+    for ( int i = 0; i < m_edges.size(); i++ )
+    {
+        Edge* edge = m_edges[i];
+        edge->reset();
+        styles[i] = edge->defaulted_style();
+        edge->set_render_data(&styles[i],nullptr);
+        QLineF* edge_handles = handles.data()+4*i;
+        edge->style().edge_type->handles(edge,edge_handles);
+        edge->set_render_data(&styles[i],edge_handles);
+    }
 
     // cycle while there are edges with untraversed handles
     while(!m_edges.empty())
@@ -322,6 +439,9 @@ void Graph::traverse(Path_Builder &path)
 #else
     qSwap(m_edges,traversed_edges);
 #endif
+
+    for(QList<Edge*>::iterator i = m_edges.begin(); i != m_edges.end(); ++i)
+        (*i)->clear_render_data();
 }
 
 
@@ -33,6 +33,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "path_builder.hpp"
 #include "traversal_info.hpp"
 #include "knot_border.hpp"
+#include "render_stats.hpp"
+#include <QHash>
 
 /**
  *  \brief Class that represents the knot (as a graph) and renders it
@@ -43,14 +45,19 @@ class Graph : public QGraphicsItem
 {
 
 private:
-    QList<Node*>        m_nodes;
-    QList<Edge*>        m_edges;
+    mutable QList<Node*>        m_nodes; ///< Removed nodes leave a null slot until compact()
+    mutable QList<Edge*>        m_edges; ///< Removed edges leave a null slot until compact()
+    mutable QHash<const Node*,int> node_slots; ///< Index of each node in m_nodes
+    mutable QHash<const Edge*,int> edge_slots; ///< Index of each edge in m_edges
+    mutable int         removed_nodes; ///< Number of null slots in m_nodes
+    mutable int         removed_edges; ///< Number of null slots in m_edges
     Node_Style          m_default_node_style;
     Edge_Style          m_default_edge_style;
     QRectF              bounding_box;
     QList<QColor>       m_colors;
     bool                auto_color;
     QList<QPainterPath> paths;    ///< Rendered knot (one per loop)
+    mutable Render_Stats m_render_stats;
     QPen                pen;
     Border_List         m_borders;
     QList<double>       border_width_cache;///< Actual width of the pen for a given border ( - width() )
@@ -59,6 +66,7 @@ private:
 public:
     explicit Graph();
     Graph(const Graph& other);
+    ~Graph();
     Graph& operator= (const Graph& other);
 
     void copy_style(const Graph& other);
@@ -83,6 +91,7 @@ public:
      *  \param n Node to be removed
      *  \pre n is in the graph and has no connected edges
      *  \post n is not in the graph
+     *  \note Constant time, the node list is compacted on the next access
      */
     void remove_node(Node* n);
     /**
@@ -90,14 +99,20 @@ public:
      *  \param e Edge to be removed
      *  \pre e is in the graph
      *  \post e is not in the graph
+     *  \note Constant time, the edge list is compacted on the next access
      */
     void remove_edge(Edge* e);
 
+    /// Whether the node is in the graph, constant time
+    bool contains(const Node* n) const { return node_slots.contains(n); }
+    /// Whether the edge is in the graph, constant time
+    bool contains(const Edge* e) const { return edge_slots.contains(e); }
+
     /*/// Remove all edges and nodes from the graph
     void clear();*/
 
-    QList<Node*> nodes() const { return m_nodes; }
-    QList<Edge*> edges() const { return m_edges; }
+    QList<Node*> nodes() const { compact(); return m_nodes; }
+    QList<Edge*> edges() const { compact(); return m_edges; }
 
 
     const QList<QColor>& colors() const { return m_colors; }
@@ -155,16 +170,25 @@ public:
     /// Traverse graph and update internal painter paths
     void render_knot();
 
+    /// Timing of the last render_knot() and paint
+    const Render_Stats& render_stats() const { return m_render_stats; }
+
     /**
      *  \brief Get a subgraph
      *
      *  \returns A graph with the same settings as this but containing only the
      *           nodes in the list
      *
+     *  \param nodes  Nodes to be included, edges are included when both
+     *                their vertices are in the list
+     *  \param render Whether to render the paths of the result,
+     *                not needed when the sub graph is only saved as XML
+     *
      *  \note This will copy the pointers to nodes/edges so any change to them will
      *          occur on both graphs.
+     *  \note Linear in the number of nodes and their edges
      */
-    Graph sub_graph(QList<Node*> nodes) const;
+    Graph sub_graph(QList<Node*> nodes, bool render = true) const;
 
     /**
      *  \brief Toggle DeviceCoordinateCache
@@ -176,6 +200,17 @@ public:
 
 private:
 
+    /// Remove the null slots left by remove_node() and remove_edge()
+    void compact() const
+    {
+        if ( removed_nodes || removed_edges )
+            compact_slots();
+    }
+    void compact_slots() const;
+
+    /// Rebuild node_slots and edge_slots from the lists
+    void reindex();
+
     void draw_segment( Path_Builder& path, const Traversal_Info& ti ) const;
 
     /// Traverse the entire graph
@@ -18,6 +18,7 @@ INCLUDEPATH += $$PWD
 HEADERS += \
     $$PWD/node.hpp \
     $$PWD/graph.hpp \
+    $$PWD/render_stats.hpp \
     $$PWD/edge.hpp \
     $$PWD/edge_type.hpp \
     $$PWD/graph_item.hpp \
@@ -28,7 +29,9 @@ HEADERS += \
     $$PWD/traversal_info.hpp \
     $$PWD/node_cusp_shape.hpp \
     $$PWD/knot_border.hpp \
-    $$PWD/edge_style.hpp
+    $$PWD/edge_style.hpp \
+    $$PWD/graph_algorithms.hpp \
+    $$PWD/interned_style.hpp
 
 SOURCES += \
     $$PWD/node.cpp \
@@ -41,4 +44,5 @@ SOURCES += \
     $$PWD/path_item.cpp \
     $$PWD/node_cusp_shape.cpp \
     $$PWD/knot_border.cpp \
-    $$PWD/edge_style.cpp
+    $$PWD/edge_style.cpp \
+    $$PWD/graph_algorithms.cpp
@@ -0,0 +1,163 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "graph_algorithms.hpp"
+
+QList<Node*> connected_nodes(const QList<Node*>& start, const QSet<Node*>& filter)
+{
+    QList<Node*> result;
+    QSet<Node*> visited;
+    visited.reserve(start.size());
+
+    foreach ( Node* n, start )
+    {
+        if ( !visited.contains(n) )
+        {
+            visited.insert(n);
+            result.push_back(n);
+        }
+    }
+
+    // result doubles as the queue
+    for ( int i = 0; i < result.size(); i++ )
+    {
+        Node* n1 = result[i];
+        foreach ( Edge* e, n1->edges() )
+        {
+            Node* n2 = e->other(n1);
+            if ( !visited.contains(n2) && ( filter.isEmpty() || filter.contains(n2) ) )
+            {
+                visited.insert(n2);
+                result.push_back(n2);
+            }
+        }
+    }
+
+    return result;
+}
+
+QList< QList<Node*> > connected_components(const QList<Node*>& nodes)
+{
+    QSet<Node*> remaining = nodes.toSet();
+    QSet<Node*> all = remaining;
+    QList< QList<Node*> > components;
+
+    foreach ( Node* n, nodes )
+    {
+        if ( !remaining.contains(n) )
+            continue;
+        QList<Node*> component = connected_nodes(QList<Node*>() << n, all);
+        foreach ( Node* c, component )
+            remaining.remove(c);
+        components.push_back(component);
+    }
+
+    return components;
+}
+
+QList<Edge*> neighbourhood_edges(const QList<Node*>& group)
+{
+    QSet<Node*> members = group.toSet();
+    QSet<Node*> found;
+    QList<Edge*> edges;
+
+    foreach ( Node* n, group )
+    {
+        foreach ( Edge* e, n->edges() )
+        {
+            Node* other = e->other(n);
+            if ( !members.contains(other) && !found.contains(other) )
+            {
+                found.insert(other);
+                edges.push_back(e);
+            }
+        }
+    }
+
+    return edges;
+}
+
+QList<Node*> neighbourhood(const QList<Node*>& group)
+{
+    QSet<Node*> members = group.toSet();
+    QList<Node*> nodes;
+    foreach ( Edge* e, neighbourhood_edges(group) )
+        nodes.push_back( members.contains(e->vertex1()) ? e->vertex2() : e->vertex1() );
+    return nodes;
+}
+
+QList<Edge*> internal_edges(const QList<Node*>& group)
+{
+    QSet<Node*> members = group.toSet();
+    QList<Edge*> edges;
+
+    foreach ( Node* n, group )
+    {
+        foreach ( Edge* e, n->edges() )
+        {
+            // each edge is reached from both vertices, add it only once
+            if ( e->vertex1() == n && members.contains(e->vertex2()) )
+                edges.push_back(e);
+        }
+    }
+
+    return edges;
+}
+
+Node_Contraction contract_nodes(const QList<Node*>& group)
+{
+    Node_Contraction contraction;
+    if ( group.empty() )
+        return contraction;
+
+    QSet<Node*> members = group.toSet();
+    QSet<Node*> found;
+
+    foreach ( Node* n, group )
+    {
+        contraction.pos += n->pos() / group.size();
+        foreach ( Edge* e, n->edges() )
+        {
+            Node* other = e->other(n);
+            if ( !members.contains(other) )
+            {
+                contraction.removed_edges.push_back(e);
+                if ( !found.contains(other) )
+                {
+                    found.insert(other);
+                    contraction.outlinks.push_back(other);
+                    contraction.outlink_types.push_back(e->style().edge_type);
+                }
+            }
+            else if ( e->vertex1() == n )
+            {
+                contraction.removed_edges.push_back(e);
+            }
+        }
+    }
+
+    return contraction;
+}
@@ -0,0 +1,90 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GRAPH_ALGORITHMS_HPP
+#define GRAPH_ALGORITHMS_HPP
+
+#include "node.hpp"
+#include "edge.hpp"
+#include <QSet>
+
+// Membership is tested with hash sets so all the functions below run in time
+// linear in the number of nodes and edges involved.
+
+/**
+ *  \brief Nodes reachable from the given ones
+ *
+ *  \param start  Nodes to start from, included in the result
+ *  \param filter If not empty, only nodes in it are visited
+ *  \return The nodes, in breadth-first order
+ */
+QList<Node*> connected_nodes(const QList<Node*>& start,
+                             const QSet<Node*>& filter = QSet<Node*>());
+
+/**
+ *  \brief Split nodes into connected components
+ *
+ *  Only edges between nodes in the list are followed
+ */
+QList< QList<Node*> > connected_components(const QList<Node*>& nodes);
+
+/**
+ *  \brief Edges linking a group of nodes to the rest of the graph
+ *
+ *  \param group Nodes in the group
+ *  \return One edge for each node outside the group connected to it
+ */
+QList<Edge*> neighbourhood_edges(const QList<Node*>& group);
+
+/**
+ *  \brief Nodes outside the group connected to it
+ */
+QList<Node*> neighbourhood(const QList<Node*>& group);
+
+/**
+ *  \brief Edges with both vertices in the group
+ */
+QList<Edge*> internal_edges(const QList<Node*>& group);
+
+/**
+ *  \brief Result of contracting a group of nodes into a single one
+ */
+struct Node_Contraction
+{
+    QPointF         pos;        ///< Average position of the group
+    QList<Node*>    outlinks;   ///< Nodes the contracted node has to be connected to
+    QList<Edge_Type*> outlink_types; ///< Edge type of the link to each outlink
+    QList<Edge*>    removed_edges; ///< Edges to be removed, internal and external
+};
+
+/**
+ *  \brief Compute the contraction of a group of nodes
+ *
+ *  The graph is not modified
+ */
+Node_Contraction contract_nodes(const QList<Node*>& group);
+
+#endif // GRAPH_ALGORITHMS_HPP
@@ -27,7 +27,40 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "graph_item.hpp"
 #include "graph.hpp"
 
+QHash<const QGraphicsScene*,Selection_Observer*> Graph_Item::selection_observers;
+
 Graph_Item::Graph_Item()
     :  highlighted(false)
 {
 }
+
+void Graph_Item::set_selection_observer(const QGraphicsScene *scene,
+                                        Selection_Observer *observer)
+{
+    if ( observer )
+        selection_observers[scene] = observer;
+    else
+        selection_observers.remove(scene);
+}
+
+QVariant Graph_Item::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if ( change == ItemSelectedHasChanged )
+        notify_selection(value.toBool());
+    else if ( change == ItemSceneChange && isSelected() )
+        notify_selection(false); // still in the old scene
+    else if ( change == ItemSceneHasChanged && isSelected() )
+        notify_selection(true);
+
+    return QGraphicsObject::itemChange(change,value);
+}
+
+void Graph_Item::notify_selection(bool selected)
+{
+    if ( scene() && !selection_observers.isEmpty() )
+    {
+        Selection_Observer* observer = selection_observers.value(scene(),nullptr);
+        if ( observer )
+            observer->item_selection_changed(this,selected);
+    }
+}
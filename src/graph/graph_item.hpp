@@ -30,8 +30,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPainter>
 #include "point_math.hpp"
 #include <QGraphicsObject>
+#include "c++.hpp"
+#include <QHash>
 class Graph;
+class Graph_Item;
 
+/**
+ * \brief Interface notified when the items in a scene are selected or deselected
+ *
+ * Items leaving the scene count as deselected and selected items added to
+ * the scene count as selected.
+ */
+class Selection_Observer
+{
+public:
+    virtual ~Selection_Observer() {}
+    virtual void item_selection_changed(Graph_Item* item, bool selected) = 0;
+};
 
 class Graph_Item : public QGraphicsObject
 {
@@ -41,6 +56,10 @@ protected:
     bool            highlighted;
     bool            visible;
 
+private:
+    /// Observers for each scene, only used in the GUI thread
+    static QHash<const QGraphicsScene*,Selection_Observer*> selection_observers;
+
 public:
     Graph_Item();
 
@@ -48,6 +67,19 @@ public:
 
     void set_highlighted(bool h) { highlighted = h; }
     void set_visible(bool h) { visible = h; }
+
+    /**
+     * \brief Set the object notified of selection changes in \p scene
+     * \param observer Observer, \c nullptr to remove it
+     */
+    static void set_selection_observer(const QGraphicsScene* scene,
+                                       Selection_Observer* observer);
+
+protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+
+private:
+    void notify_selection(bool selected);
 };
 
 #endif // GRAPH_ITEM_HPP
@@ -0,0 +1,138 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef INTERNED_STYLE_HPP
+#define INTERNED_STYLE_HPP
+
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+
+/**
+ * \brief Reference to a style stored once in a process-wide table
+ *
+ * Equal styles share the same storage, which is released when the last
+ * reference goes away. The referenced style is immutable, assign a new
+ * style to change it.
+ *
+ * \note Safe to be used from multiple threads
+ */
+template<class Style>
+class Interned_Style
+{
+    struct Entry
+    {
+        Style       style;
+        QAtomicInt  references;
+
+        explicit Entry(const Style& style) : style(style), references(1) {}
+    };
+    typedef QHash<Style,Entry*> Table;
+
+    Entry* entry;
+
+    /// Never destroyed, styles can outlive static objects
+    static Table& table()
+    {
+        static Table* table = new Table;
+        return *table;
+    }
+
+    static QMutex& mutex()
+    {
+        static QMutex* mutex = new QMutex;
+        return *mutex;
+    }
+
+    static Entry* acquire(const Style& style)
+    {
+        QMutexLocker lock(&mutex());
+        Entry*& entry = table()[style];
+        if ( entry )
+            entry->references.ref();
+        else
+            entry = new Entry(style);
+        return entry;
+    }
+
+    static void release(Entry* entry)
+    {
+        QMutexLocker lock(&mutex());
+        if ( !entry->references.deref() )
+        {
+            table().remove(entry->style);
+            delete entry;
+        }
+    }
+
+public:
+    Interned_Style(const Style& style = Style()) : entry(acquire(style)) {}
+
+    Interned_Style(const Interned_Style& other) : entry(other.entry)
+    {
+        entry->references.ref();
+    }
+
+    ~Interned_Style()
+    {
+        release(entry);
+    }
+
+    Interned_Style& operator= (const Interned_Style& other)
+    {
+        if ( other.entry != entry )
+        {
+            other.entry->references.ref();
+            release(entry);
+            entry = other.entry;
+        }
+        return *this;
+    }
+
+    Interned_Style& operator= (const Style& style)
+    {
+        Entry* old = entry;
+        entry = acquire(style);
+        release(old);
+        return *this;
+    }
+
+    const Style& operator* () const { return entry->style; }
+    const Style* operator-> () const { return &entry->style; }
+
+    /// Constant time, equal styles share the same entry
+    bool operator== (const Interned_Style& other) const { return entry == other.entry; }
+    bool operator!= (const Interned_Style& other) const { return entry != other.entry; }
+
+    /// Number of distinct styles in use
+    static int distinct_styles()
+    {
+        QMutexLocker lock(&mutex());
+        return table().size();
+    }
+};
+
+#endif // INTERNED_STYLE_HPP
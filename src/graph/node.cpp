@@ -44,13 +44,25 @@ Node::Node(QPointF pos)
 
 void Node::add_edge(Edge *e)
 {
-    if ( !m_edges.contains(e) )
+    int& slot = e->adjacency_slot(this);
+    if ( slot < 0 )
+    {
+        slot = m_edges.size();
         m_edges.append(e);
+    }
 }
 
 void Node::remove_edge(Edge *e)
 {
-    m_edges.removeOne(e);
+    int& slot = e->adjacency_slot(this);
+    if ( slot < 0 )
+        return;
+    // move the last edge in the removed slot
+    Edge* last = m_edges.back();
+    m_edges[slot] = last;
+    last->adjacency_slot(this) = slot;
+    m_edges.pop_back();
+    slot = -1;
 }
 
 bool Node::has_edge_to(const Node *n) const
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPointF>
 #include "graph_item.hpp"
 #include "node_style.hpp"
+#include "interned_style.hpp"
 #include <QPainter>
 #include "c++.hpp"
 
@@ -51,24 +52,25 @@ public:
 private:
     QList<Edge*> m_edges;
 
-    Node_Style m_style;
+    Interned_Style<Node_Style> m_style;
 
 public:
     Node(QPointF pos );
 
-    Node_Style& style() { return m_style; }
+    const Node_Style& style() const { return *m_style; }
 
-    void set_style(Node_Style st) { m_style = st; }
+    void set_style(const Node_Style& st) { m_style = st; }
 
     /**
      *  Add edge to node
      *  \param e Edge to be added
+     *  \note Constant time, the edge keeps track of its position in the list
      */
     void add_edge(Edge* e);
     /**
      *  Remove edge from node
      *  \param e Edge to be removed
-     *  \pre e is in the edge list
+     *  \note Constant time, the last edge in the list takes its place
      */
     void remove_edge(Edge*e);
     /**
@@ -67,8 +67,8 @@ void Cusp_Rounded::draw_joint(Path_Builder &path, const Traversal_Info &ti,
                               const Node_Style &style) const
 {
 
-    QLineF start = ti.in.edge->style().edge_type->handle(ti.in.edge,ti.in.handle);
-    QLineF finish = ti.out.edge->style().edge_type->handle(ti.out.edge,ti.out.handle);
+    QLineF start = ti.in.edge->handle(ti.in.handle);
+    QLineF finish = ti.out.edge->handle(ti.out.handle);
 
     if ( ti.angle_delta > style.cusp_angle  ) // draw cusp
     {
@@ -94,8 +94,8 @@ void Cusp_Rounded::draw_joint(Path_Builder &path, const Traversal_Info &ti,
 
 void Cusp_Pointed::draw_joint(Path_Builder &path, const Traversal_Info &ti, const Node_Style &style) const
 {
-    QLineF start = ti.in.edge->style().edge_type->handle(ti.in.edge,ti.in.handle);
-    QLineF finish = ti.out.edge->style().edge_type->handle(ti.out.edge,ti.out.handle);
+    QLineF start = ti.in.edge->handle(ti.in.handle);
+    QLineF finish = ti.out.edge->handle(ti.out.handle);
 
     if ( ti.angle_delta > style.cusp_angle  ) // draw cusp
     {
@@ -115,8 +115,8 @@ void Cusp_Pointed::draw_joint(Path_Builder &path, const Traversal_Info &ti, cons
 
 void Cusp_Ogee::draw_joint(Path_Builder &path, const Traversal_Info &ti, const Node_Style &style) const
 {
-    QLineF start = ti.in.edge->style().edge_type->handle(ti.in.edge,ti.in.handle);
-    QLineF finish = ti.out.edge->style().edge_type->handle(ti.out.edge,ti.out.handle);
+    QLineF start = ti.in.edge->handle(ti.in.handle);
+    QLineF finish = ti.out.edge->handle(ti.out.handle);
 
     if ( ti.angle_delta > style.cusp_angle  ) // draw cusp
     {
@@ -145,8 +145,8 @@ void Cusp_Ogee::draw_joint(Path_Builder &path, const Traversal_Info &ti, const N
 
 void Cusp_Polygonal::draw_joint(Path_Builder &path, const Traversal_Info &ti, const Node_Style &style) const
 {
-    QLineF start = ti.in.edge->style().edge_type->handle(ti.in.edge,ti.in.handle);
-    QLineF finish = ti.out.edge->style().edge_type->handle(ti.out.edge,ti.out.handle);
+    QLineF start = ti.in.edge->handle(ti.in.handle);
+    QLineF finish = ti.out.edge->handle(ti.out.handle);
 
     if ( ti.angle_delta > style.cusp_angle  ) // draw cusp
     {
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "node_style.hpp"
+#include "point_math.hpp"
 
 Node_Style Node_Style::default_to(const Node_Style &other) const
 {
@@ -38,3 +39,9 @@ Node_Style Node_Style::default_to(const Node_Style &other) const
             );
 }
 
+uint qHash(const Node_Style &style)
+{
+    return uint(style.enabled_style) ^ hash_double(style.cusp_angle) ^
+           (hash_double(style.handle_length) << 1) ^
+           (hash_double(style.cusp_distance) << 2) ^ qHash(style.cusp_shape);
+}
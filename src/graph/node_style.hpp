@@ -76,6 +76,15 @@ public:
     /// Set disabled style to the values in other
     Node_Style default_to(const Node_Style& other) const;
 
+    bool operator== (const Node_Style& o) const
+    {
+        return enabled_style == o.enabled_style && cusp_angle == o.cusp_angle &&
+               handle_length == o.handle_length && cusp_distance == o.cusp_distance &&
+               cusp_shape == o.cusp_shape;
+    }
+
+    bool operator!= (const Node_Style& o) const { return !(*this == o); }
+
     void build(const Traversal_Info& ti,Path_Builder&path,
                const Node_Style& default_style ) const
     {
@@ -87,6 +96,8 @@ public:
 
 };
 
+uint qHash(const Node_Style& style);
+
 Q_DECLARE_METATYPE(Node_Style::Enabled_Styles)
 
 #endif // NODE_STYLE_HPP
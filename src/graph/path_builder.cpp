@@ -25,8 +25,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "path_builder.hpp"
+#include "trace.hpp"
 
 Path_Builder::Path_Builder()
+    : segments(0)
 {
 }
 
@@ -40,6 +42,8 @@ Path_Builder::~Path_Builder()
 
 void Path_Builder::add_line(path_item::Line *current)
 {
+    segments++;
+
     if ( strokes.empty() )
         new_group();
 
@@ -98,6 +102,7 @@ void Path_Builder::new_group()
 
 QList<QPainterPath> Path_Builder::build()
 {
+    TRACE_SCOPE("Path_Builder::build");
     if ( strokes.empty() )
         return QList<QPainterPath>();
 
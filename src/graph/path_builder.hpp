@@ -47,6 +47,7 @@ protected:
      *  The data is stored in groups, hence the nested list
      */
     container strokes;
+    int       segments; ///< Number of items added, before merging
 
     Path_Builder(const Path_Builder&);
     Path_Builder& operator= (const Path_Builder&);
@@ -64,6 +65,9 @@ public:
     void new_group();
 
     QList<QPainterPath> build();
+
+    /// Number of lines and curves added so far
+    int segment_count() const { return segments; }
 };
 
 
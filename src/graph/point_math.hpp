@@ -30,6 +30,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPointF>
 #include <QLineF>
 #include <qmath.h>
+#include <QHash>
+#include <cstring>
 #include "c++.hpp"
 
 inline bool qFuzzyCompare ( QPointF p1, QPointF p2 )
@@ -49,6 +51,16 @@ inline double point_distance(const QPointF &p1, const QPointF &p2 )
     return qSqrt(point_distance_squared(p1,p2));
 }
 
+/// Hash the bits of \p value, 0 and -0 compare equal so they hash the same
+inline uint hash_double(double value)
+{
+    if ( value == 0 )
+        value = 0;
+    quint64 bits;
+    std::memcpy(&bits,&value,sizeof(bits));
+    return qHash(bits);
+}
+
 /*inline double line_point_distance_squared(const QPointF& p1, const QPointF &p2,
                                           const QPointF &to)
 {
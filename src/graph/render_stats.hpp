@@ -0,0 +1,64 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RENDER_STATS_HPP
+#define RENDER_STATS_HPP
+
+#include <QElapsedTimer>
+
+/**
+ * \brief Timing and size of the last render and paint of a Graph
+ */
+struct Render_Stats
+{
+    qint64  traverse;       ///< Nanoseconds spent traversing the graph
+    qint64  path_build;     ///< Nanoseconds spent building the painter paths
+    qint64  bounding_box;   ///< Nanoseconds spent updating the bounding box
+    qint64  paint;          ///< Nanoseconds spent painting the paths
+    int     segments;       ///< Path segments produced by the traversal
+    int     loops;          ///< Painter paths, one per loop
+    qint64  renders;        ///< Number of renders since the graph has been created
+
+    Render_Stats()
+        : traverse(0), path_build(0), bounding_box(0), paint(0),
+          segments(0), loops(0), renders(0)
+    {}
+
+    /// Nanoseconds spent in the last render
+    qint64 render() const { return traverse + path_build + bounding_box; }
+
+    /// Elapsed time of \p timer in nanoseconds
+    static qint64 nanoseconds(const QElapsedTimer& timer)
+    {
+#if HAS_QT_4_8
+        return timer.nsecsElapsed();
+#else
+        return timer.elapsed()*1000000;
+#endif
+    }
+};
+
+#endif // RENDER_STATS_HPP
@@ -0,0 +1,250 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "autosave.hpp"
+#include "xml_exporter.hpp"
+#include "resource_manager.hpp"
+#include <QRunnable>
+#include <QBuffer>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QCoreApplication>
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#elif defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#endif
+
+/**
+ * \brief Whether a process with the given id is running
+ *
+ * Used to tell snapshots of other running instances from the ones left
+ * behind by a crash
+ */
+static bool process_running(qint64 pid)
+{
+    if ( pid <= 0 )
+        return false;
+    if ( pid == QCoreApplication::applicationPid() )
+        return true;
+#if defined(Q_OS_UNIX)
+    return ::kill(pid_t(pid),0) == 0 || errno == EPERM;
+#elif defined(Q_OS_WIN)
+    HANDLE process = ::OpenProcess(SYNCHRONIZE,FALSE,DWORD(pid));
+    if ( !process )
+        return false;
+    bool running = ::WaitForSingleObject(process,0) == WAIT_TIMEOUT;
+    ::CloseHandle(process);
+    return running;
+#else
+    return false;
+#endif
+}
+
+/**
+ * \brief Write \p data to \p file_name making sure it reaches the disk
+ *
+ * Data is written to a temporary file which replaces \p file_name only
+ * once it's complete, so a crash while saving doesn't leave a broken snapshot
+ */
+static bool write_synced(QString file_name, const QByteArray& data)
+{
+    QString temp_name = file_name+".tmp";
+    QFile file(temp_name);
+    if ( !file.open(QIODevice::WriteOnly) )
+        return false;
+
+    bool ok = file.write(data) == data.size() && file.flush();
+#if defined(Q_OS_UNIX)
+    ok = ok && ::fsync(file.handle()) == 0;
+#elif defined(Q_OS_WIN)
+    ok = ok && ::_commit(file.handle()) == 0;
+#endif
+    file.close();
+
+    if ( ok )
+    {
+        QFile::remove(file_name);
+        ok = QFile::rename(temp_name,file_name);
+    }
+    if ( !ok )
+        QFile::remove(temp_name);
+    return ok;
+}
+
+/**
+ * \brief Background job serializing a snapshot
+ */
+class Autosave_Writer : public QRunnable
+{
+    Knot_Snapshot   snapshot;
+    QString         directory;
+    QString         id;
+    QString         original;
+    Autosave*       owner;
+
+public:
+    Autosave_Writer(const Graph& graph, QString directory, QString id,
+                    QString original, Autosave* owner)
+        : snapshot(graph), directory(directory), id(id),
+          original(original), owner(owner)
+    {}
+
+    void run() override
+    {
+        QByteArray knot_xml;
+        QBuffer buffer(&knot_xml);
+        export_xml(snapshot,buffer);
+        buffer.close();
+
+        QDir dir(directory);
+        if ( dir.mkpath(".") &&
+             write_synced(dir.absoluteFilePath(id+".knot"),knot_xml) )
+        {
+            write_synced(dir.absoluteFilePath(id+".path"),original.toUtf8());
+        }
+
+        QMetaObject::invokeMethod(owner,"write_finished",Qt::QueuedConnection,
+                                  Q_ARG(QString,id));
+    }
+};
+
+Autosave::Autosave(QObject *parent) :
+    QObject(parent), next_id(0)
+{
+    pool.setMaxThreadCount(1);
+}
+
+Autosave::~Autosave()
+{
+    pool.waitForDone();
+}
+
+void Autosave::store(const QObject *document, const Graph &graph,
+                     QString file_name, int revision)
+{
+    Document& doc = documents[document];
+    if ( doc.pending || doc.revision == revision )
+        return;
+
+    // The pid identifies the owner, see recovery_files()
+    if ( doc.id.isEmpty() )
+        doc.id = QString("%1-%2").arg(QCoreApplication::applicationPid())
+                                 .arg(next_id++);
+    doc.revision = revision;
+    doc.pending = true;
+    doc.discarded = false;
+
+    pool.start(new Autosave_Writer(graph,recovery_directory(),doc.id,file_name,this));
+}
+
+void Autosave::discard(const QObject *document)
+{
+    QHash<const QObject*,Document>::iterator it = documents.find(document);
+    if ( it == documents.end() )
+        return;
+
+    if ( it->pending )
+    {
+        it->discarded = true;
+        it->revision = -1;
+    }
+    else
+    {
+        remove_files(it->id);
+        documents.erase(it);
+    }
+}
+
+void Autosave::discard_all()
+{
+    pool.waitForDone();
+    foreach ( const Document& doc, documents )
+        remove_files(doc.id);
+    documents.clear();
+}
+
+QString Autosave::recovery_directory()
+{
+    return resource_manager().program.writable_data_directory("recovery");
+}
+
+QStringList Autosave::recovery_files()
+{
+    QDir dir(recovery_directory());
+    QStringList files;
+    foreach ( QString name, dir.entryList(QStringList() << "*.knot",QDir::Files,QDir::Time) )
+    {
+        // Skip live snapshots of instances that are still running
+        qint64 owner = name.section('-',0,0).toLongLong();
+        if ( !process_running(owner) )
+            files << dir.absoluteFilePath(name);
+    }
+    return files;
+}
+
+QString Autosave::original_file(QString recovery_file)
+{
+    QFileInfo info(recovery_file);
+    QFile file(info.dir().absoluteFilePath(info.completeBaseName()+".path"));
+    if ( !file.open(QIODevice::ReadOnly) )
+        return QString();
+    return QString::fromUtf8(file.readAll());
+}
+
+void Autosave::remove_recovery_file(QString recovery_file)
+{
+    QFileInfo info(recovery_file);
+    QFile::remove(recovery_file);
+    QFile::remove(info.dir().absoluteFilePath(info.completeBaseName()+".path"));
+}
+
+void Autosave::write_finished(QString id)
+{
+    for ( QHash<const QObject*,Document>::iterator it = documents.begin();
+            it != documents.end(); ++it )
+    {
+        if ( it->id == id )
+        {
+            it->pending = false;
+            if ( it->discarded )
+            {
+                remove_files(id);
+                documents.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+void Autosave::remove_files(QString id)
+{
+    remove_recovery_file(QDir(recovery_directory()).absoluteFilePath(id+".knot"));
+}
@@ -0,0 +1,116 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef AUTOSAVE_HPP
+#define AUTOSAVE_HPP
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QThreadPool>
+#include "graph.hpp"
+
+/**
+ * \brief Writes crash recovery snapshots of open documents
+ *
+ * The graph is copied by value on the caller thread, serialization and
+ * disk writes happen on a background thread so editing is never blocked.
+ */
+class Autosave : public QObject
+{
+    Q_OBJECT
+
+    struct Document
+    {
+        QString id;         ///< Base name of the recovery files
+        int     revision;   ///< Revision of the last snapshot
+        bool    pending;    ///< A snapshot is being written
+        bool    discarded;  ///< Remove the files once the pending write is done
+
+        Document() : revision(-1), pending(false), discarded(false) {}
+    };
+
+    QHash<const QObject*,Document> documents;
+    int         next_id;
+    QThreadPool pool;   ///< Single thread, keeps writes ordered
+
+public:
+    explicit Autosave(QObject *parent = 0);
+    ~Autosave();
+
+    /**
+     * \brief Write a recovery snapshot of \p graph
+     * \param document  Object identifying the document (eg: its view)
+     * \param graph     Contents to be saved, copied before returning
+     * \param file_name Name of the file the document will be recovered as
+     * \param revision  Snapshots are written only when this changes
+     */
+    void store(const QObject* document, const Graph& graph,
+               QString file_name, int revision);
+
+    /**
+     * \brief Remove the recovery snapshot of \p document
+     *
+     * Called when the document is saved or closed normally.
+     */
+    void discard(const QObject* document);
+
+    /**
+     * \brief Remove all the snapshots written by this object
+     */
+    void discard_all();
+
+    /**
+     * \brief Directory containing the recovery files
+     */
+    static QString recovery_directory();
+
+    /**
+     * \brief Snapshots left behind by a previous session
+     *
+     * Snapshots owned by a process that is still running are not included
+     */
+    static QStringList recovery_files();
+
+    /**
+     * \brief Name of the file \p recovery_file is a snapshot of
+     * \return The original file name, empty if the file was never saved
+     */
+    static QString original_file(QString recovery_file);
+
+    /**
+     * \brief Remove a snapshot once it has been recovered or dismissed
+     */
+    static void remove_recovery_file(QString recovery_file);
+
+private slots:
+    void write_finished(QString id);
+
+private:
+    void remove_files(QString id);
+};
+
+#endif // AUTOSAVE_HPP
@@ -27,10 +27,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "image_exporter.hpp"
 
 #include <QSvgGenerator>
+#include "trace.hpp"
 
 
 void export_svg(QIODevice &file, const Graph& graph, bool draw_graph, bool draw_bg_image, const Background_Image &bg_img)
 {
+    TRACE_SCOPE("export_svg");
     if ( !file.isWritable() && !file.open(QIODevice::WriteOnly|QIODevice::Text))
     {
         return;
@@ -64,6 +66,7 @@ void export_raster(QIODevice &file, const Graph& graph, QColor background,
                    bool draw_bg_image, const Background_Image& bg_img,
                    const char* format )
 {
+    TRACE_SCOPE("export_raster");
 
     if ( !file.isWritable() && !file.open(QIODevice::WriteOnly))
     {
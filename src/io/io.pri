@@ -21,7 +21,10 @@ HEADERS += \
     $$PWD/xml_loader_v3.hpp \
     $$PWD/xml_exporter.hpp \
     $$PWD/xml_loader_v4.hpp \
-    $$PWD/xml_loader.hpp
+    $$PWD/xml_loader.hpp \
+    $$PWD/knot_snapshot.hpp \
+    $$PWD/autosave.hpp \
+    $$PWD/knot_loader.hpp
 
 SOURCES += \
     $$PWD/image_exporter.cpp \
@@ -29,4 +32,6 @@ SOURCES += \
     $$PWD/xml_loader_v3.cpp \
     $$PWD/xml_exporter.cpp \
     $$PWD/xml_loader_v4.cpp \
-    $$PWD/xml_loader.cpp
+    $$PWD/xml_loader.cpp \
+    $$PWD/autosave.cpp \
+    $$PWD/knot_loader.cpp
@@ -0,0 +1,79 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "knot_loader.hpp"
+#include "xml_loader.hpp"
+#include <QFile>
+
+Knot_Loader::Knot_Loader(QString file_name, QObject *parent)
+    : QThread(parent), m_file_name(file_name), m_graph(nullptr), m_success(false),
+      m_owns_graph(true), m_cancelled(0),
+      target_thread(QThread::currentThread())
+{
+}
+
+Knot_Loader::~Knot_Loader()
+{
+    cancel();
+    wait();
+
+    if ( m_graph )
+    {
+        if ( m_owns_graph )
+        {
+            foreach ( Edge* e, m_graph->edges() )
+                delete e;
+            foreach ( Node* n, m_graph->nodes() )
+                delete n;
+        }
+        delete m_graph;
+    }
+}
+
+void Knot_Loader::cancel()
+{
+    m_cancelled.fetchAndStoreRelease(1);
+}
+
+void Knot_Loader::run()
+{
+    // Created here so the graph and its items belong to this thread while loading
+    m_graph = new Graph;
+
+    // Not import_xml(QString,Graph&): its cache is meant for small files
+    // loaded repeatedly by scripts, not for whole documents
+    QFile file(m_file_name);
+    m_success = import_xml(file,*m_graph);
+
+    if ( cancelled() )
+        return;
+
+    foreach ( Node* n, m_graph->nodes() )
+        n->moveToThread(target_thread);
+    foreach ( Edge* e, m_graph->edges() )
+        e->moveToThread(target_thread);
+    m_graph->moveToThread(target_thread);
+}
@@ -0,0 +1,89 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef KNOT_LOADER_HPP
+#define KNOT_LOADER_HPP
+
+#include <QThread>
+#include <QAtomicInt>
+#include "graph.hpp"
+
+/**
+ * \brief Loads a knot file in a background thread
+ *
+ * The result is a Graph not attached to any scene, its nodes and edges
+ * are moved to the thread which created the loader, ready to be handed
+ * to a Knot_View.
+ */
+class Knot_Loader : public QThread
+{
+    Q_OBJECT
+
+    QString         m_file_name;
+    Graph*          m_graph;        ///< Created by run() in the loader thread
+    bool            m_success;
+    bool            m_owns_graph;   ///< Delete nodes and edges on destruction
+    mutable QAtomicInt m_cancelled; ///< Set from the GUI thread, read by run()
+    QThread*        target_thread;
+
+public:
+    explicit Knot_Loader(QString file_name, QObject *parent = 0);
+    ~Knot_Loader();
+
+    QString file_name() const { return m_file_name; }
+
+    /**
+     * \brief Whether the file has been loaded successfully
+     * \pre The thread has finished
+     */
+    bool success() const { return m_success; }
+
+    bool cancelled() const { return m_cancelled.fetchAndAddAcquire(0); }
+
+    /**
+     * \brief Loaded graph
+     * \pre The thread has finished successfully
+     */
+    Graph& graph() { return *m_graph; }
+
+    /**
+     * \brief Called once the nodes and edges of graph() have been taken elsewhere
+     */
+    void release_graph() { m_owns_graph = false; }
+
+public slots:
+    /**
+     * \brief Discard the result
+     *
+     * Parsing is not interrupted but nothing will be handed back
+     */
+    void cancel();
+
+protected:
+    void run() override;
+};
+
+#endif // KNOT_LOADER_HPP
@@ -0,0 +1,156 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef KNOT_SNAPSHOT_HPP
+#define KNOT_SNAPSHOT_HPP
+
+#include "graph.hpp"
+#include <QVector>
+#include <QHash>
+
+/**
+ * \brief Compact contents of a knot, independent from any Graph
+ *
+ * Nodes and edges are stored as parallel arrays of plain values, styles are
+ * stored once and referenced by index. This is what gets cached, saved and
+ * handed to other threads, a Graph with its scene items is created only
+ * when a knot is displayed.
+ */
+struct Knot_Snapshot
+{
+    QVector<QPointF>    node_pos;
+    QVector<int>        node_style;     ///< Index in node_styles
+    QVector<int>        edge_vertex1;   ///< Index in node_pos
+    QVector<int>        edge_vertex2;   ///< Index in node_pos
+    QVector<int>        edge_style;     ///< Index in edge_styles
+
+    QVector<Node_Style> node_styles;    ///< Distinct styles used by the nodes
+    QVector<Edge_Style> edge_styles;    ///< Distinct styles used by the edges
+
+    Node_Style          default_node_style;
+    Edge_Style          default_edge_style;
+    QList<QColor>       colors;
+    bool                custom_colors;
+    double              width;
+    Qt::PenJoinStyle    join_style;
+    Qt::BrushStyle      brush_style;
+    Border_List         borders;
+    bool                paint_border;
+
+    /**
+     * \brief Take the contents of \p graph, nodes and edges are not referenced afterwards
+     * \param with_items If false only the graph style is copied
+     */
+    explicit Knot_Snapshot(const Graph& graph, bool with_items = true)
+        : default_node_style(graph.default_node_style()),
+          default_edge_style(graph.default_edge_style()),
+          colors(graph.colors()), custom_colors(graph.custom_colors()),
+          width(graph.width()), join_style(graph.join_style()),
+          brush_style(graph.brush_style()), borders(graph.borders()),
+          paint_border(graph.paint_border())
+    {
+        if ( !with_items )
+            return;
+
+        QList<Node*> nodes = graph.nodes();
+        QList<Edge*> edges = graph.edges();
+        node_pos.reserve(nodes.size());
+        node_style.reserve(nodes.size());
+        edge_vertex1.reserve(edges.size());
+        edge_vertex2.reserve(edges.size());
+        edge_style.reserve(edges.size());
+
+        QHash<Node*,int> index;
+        index.reserve(nodes.size());
+        QHash<Node_Style,int> node_style_index;
+        foreach ( Node* n, nodes )
+        {
+            index[n] = node_pos.size();
+            node_pos.push_back(n->pos());
+            node_style.push_back(intern(node_styles,node_style_index,n->style()));
+        }
+
+        QHash<Edge_Style,int> edge_style_index;
+        foreach ( Edge* e, edges )
+        {
+            edge_vertex1.push_back(index[e->vertex1()]);
+            edge_vertex2.push_back(index[e->vertex2()]);
+            edge_style.push_back(intern(edge_styles,edge_style_index,e->style()));
+        }
+    }
+
+    int node_count() const { return node_pos.size(); }
+    int edge_count() const { return edge_vertex1.size(); }
+
+    const Node_Style& style_of_node(int i) const { return node_styles[node_style[i]]; }
+    const Edge_Style& style_of_edge(int i) const { return edge_styles[edge_style[i]]; }
+
+    /// Create new nodes and edges in \p graph
+    void copy_to(Graph& graph) const
+    {
+        graph.set_default_node_style(default_node_style);
+        graph.set_default_edge_style(default_edge_style);
+        graph.set_colors(colors);
+        graph.set_custom_colors(custom_colors);
+        graph.set_width(width);
+        graph.set_join_style(join_style);
+        graph.set_brush_style(brush_style);
+        graph.set_borders(borders);
+        graph.set_paint_border(paint_border);
+
+        QVector<Node*> nodes;
+        nodes.reserve(node_count());
+        for ( int i = 0; i < node_count(); i++ )
+        {
+            Node* n = new Node(node_pos[i]);
+            n->set_style(style_of_node(i));
+            graph.add_node(n);
+            nodes.push_back(n);
+        }
+        for ( int i = 0; i < edge_count(); i++ )
+        {
+            const Edge_Style& style = style_of_edge(i);
+            Edge* e = new Edge(nodes[edge_vertex1[i]],nodes[edge_vertex2[i]],
+                               style.edge_type);
+            e->set_style(style);
+            graph.add_edge(e);
+        }
+    }
+
+private:
+    /// Index of \p style in \p table, appended if not already there
+    template<class Style>
+        static int intern(QVector<Style>& table, QHash<Style,int>& index, const Style& style)
+        {
+            typename QHash<Style,int>::const_iterator it = index.find(style);
+            if ( it != index.end() )
+                return *it;
+            table.push_back(style);
+            return index[style] = table.size()-1;
+        }
+};
+
+#endif // KNOT_SNAPSHOT_HPP
@@ -41,21 +41,26 @@ XML_Exporter::XML_Exporter(QIODevice *output,bool pretty_xml)
 }
 
 void XML_Exporter::export_graph(const Graph * graph)
+{
+    export_graph(Knot_Snapshot(*graph));
+}
+
+void XML_Exporter::export_graph(const Knot_Snapshot &knot)
 {
     begin();
 
-    save_style(graph);
+    save_style(knot);
 
     start_element("graph");
 
     start_element("nodes");
-    foreach(Node* node, graph->nodes())
-        save_node(node);
+    for ( int i = 0; i < knot.node_count(); i++ )
+        save_node(knot,i);
     end_element(); // nodes
 
     start_element("edges");
-    foreach(Edge* edge, graph->edges())
-        save_edge(edge);
+    for ( int i = 0; i < knot.edge_count(); i++ )
+        save_edge(knot,i);
     end_element(); // edges
 
     end();
@@ -88,16 +93,21 @@ void XML_Exporter::end_element()
 }
 
 void XML_Exporter::save_style(const Graph *graph)
+{
+    save_style(Knot_Snapshot(*graph,false));
+}
+
+void XML_Exporter::save_style(const Knot_Snapshot &knot)
 {
     start_element("style");
 
     start_element("colors");
-    foreach(QColor c, graph->colors())
+    foreach(QColor c, knot.colors)
         save_color("color",c);
     end_element(); // colors
 
     start_element("borders");
-    foreach(Knot_Border b, graph->borders())
+    foreach(Knot_Border b, knot.borders)
     {
         start_element("border");
         xml.writeAttribute("width",QString::number(b.width));
@@ -108,21 +118,21 @@ void XML_Exporter::save_style(const Graph *graph)
     }
     end_element(); // borders
 
-    save_cusp("cusp",graph->default_node_style());
-    save_crossing("crossing",graph->default_edge_style());
+    save_cusp("cusp",knot.default_node_style);
+    save_crossing("crossing",knot.default_edge_style);
 
     start_element("stroke");
 
-    xml.writeTextElement("width",QString::number(graph->width()));
+    xml.writeTextElement("width",QString::number(knot.width));
 
     const QMetaObject& mo = staticQtMetaObject;
 
     QMetaEnum bs_me = mo.enumerator(mo.indexOfEnumerator("BrushStyle"));
-    xml.writeTextElement("style",bs_me.valueToKey(graph->brush_style()));
+    xml.writeTextElement("style",bs_me.valueToKey(knot.brush_style));
 
 
     QMetaEnum pjs_me = mo.enumerator(mo.indexOfEnumerator("PenJoinStyle"));
-    xml.writeTextElement("join",pjs_me.valueToKey(graph->join_style()));
+    xml.writeTextElement("join",pjs_me.valueToKey(knot.join_style));
 
     end_element(); // stroke
 
@@ -167,29 +177,30 @@ void XML_Exporter::save_crossing(QString name, Edge_Style style)
     end_element();
 }
 
-void XML_Exporter::save_node(Node *node)
+void XML_Exporter::save_node(const Knot_Snapshot &knot, int node)
 {
-    int id = node_id(node);
-
+    const Node_Style& style = knot.style_of_node(node);
 
     start_element("node");
-        xml.writeAttribute("id",QString("node_%1").arg(id));
-        xml.writeAttribute("x",QString::number(node->pos().x()));
-        xml.writeAttribute("y",QString::number(node->pos().y()));
-        if ( node->style().enabled_style != Node_Style::NOTHING )
-            save_cusp("style",node->style());
+        xml.writeAttribute("id",QString("node_%1").arg(node));
+        xml.writeAttribute("x",QString::number(knot.node_pos[node].x()));
+        xml.writeAttribute("y",QString::number(knot.node_pos[node].y()));
+        if ( style.enabled_style != Node_Style::NOTHING )
+            save_cusp("style",style);
     end_element(); // node
 
 }
 
-void XML_Exporter::save_edge(Edge *edge)
+void XML_Exporter::save_edge(const Knot_Snapshot &knot, int edge)
 {
+    const Edge_Style& style = knot.style_of_edge(edge);
+
     start_element("edge");
-    xml.writeAttribute("type", edge->style().edge_type->machine_name());
-    xml.writeAttribute("v1",QString("node_%1").arg(node_id(edge->vertex1())));
-    xml.writeAttribute("v2",QString("node_%1").arg(node_id(edge->vertex2())));
-    if ( edge->style().enabled_style & (Edge_Style::EVERYTHING^Edge_Style::EDGE_TYPE) )
-        save_crossing("style",edge->style());
+    xml.writeAttribute("type", style.edge_type->machine_name());
+    xml.writeAttribute("v1",QString("node_%1").arg(knot.edge_vertex1[edge]));
+    xml.writeAttribute("v2",QString("node_%1").arg(knot.edge_vertex2[edge]));
+    if ( style.enabled_style & (Edge_Style::EVERYTHING^Edge_Style::EDGE_TYPE) )
+        save_crossing("style",style);
     end_element(); // edge
 }
 
@@ -202,21 +213,22 @@ void XML_Exporter::save_color(QString name, QColor col)
     end_element();
 }
 
-int XML_Exporter::node_id(Node *node)
+bool export_xml(const Graph& graph, QIODevice &file )
 {
-    if ( node_ids.contains(node) )
-        return node_ids[node];
-    else
-        return node_ids[node] = node_ids.size();
-}
+    if ( !file.isWritable() && !file.open(QIODevice::WriteOnly | QIODevice::Text) )
+        return false;
 
+    XML_Exporter(&file).export_graph(&graph);
 
-bool export_xml(const Graph& graph, QIODevice &file )
+    return true;
+}
+
+bool export_xml(const Knot_Snapshot &knot, QIODevice &file)
 {
     if ( !file.isWritable() && !file.open(QIODevice::WriteOnly | QIODevice::Text) )
         return false;
 
-    XML_Exporter(&file).export_graph(&graph);
+    XML_Exporter(&file).export_graph(knot);
 
     return true;
 }
@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define XML_EXPORTER_HPP
 #include <QXmlStreamWriter>
 #include "graph.hpp"
+#include "knot_snapshot.hpp"
 #include <QMimeData>
 
 class XML_Exporter : public QObject
@@ -42,15 +43,16 @@ class XML_Exporter : public QObject
     static const int version = 4;
 
     QXmlStreamWriter xml;
-    QMap<Node*,int> node_ids;
 
 public:
     XML_Exporter(QIODevice* output, bool pretty_xml=true);
 
     /// Create xml document
     void export_graph(const Graph *graph);
+    void export_graph(const Knot_Snapshot& knot);
 
     void save_style (const Graph *graph );
+    void save_style (const Knot_Snapshot& knot );
 protected:
     void begin ();
     void end();
@@ -62,21 +64,23 @@ protected:
     void save_cusp (QString name, Node_Style style );
     void save_crossing (QString name, Edge_Style style );
 
-    void save_node ( Node* node );
+    /// Save the node at index \p node, its index is used as ID
+    void save_node ( const Knot_Snapshot& knot, int node );
 
-    void save_edge ( Edge* edge );
+    void save_edge ( const Knot_Snapshot& knot, int edge );
 
     void save_color(QString name, QColor col);
-
-    /**
-     *  \brief Get the unique ID associated with the given node
-     */
-    int node_id ( Node* node );
 };
 
 
 bool export_xml(const Graph& graph, QIODevice &file );
 
+/**
+ * \brief Save a knot without going through its scene items
+ * \note Safe to be called from other threads
+ */
+bool export_xml(const Knot_Snapshot& knot, QIODevice &file );
+
 void export_xml_mime_data(QMimeData* data, const Graph& graph);
 
 QByteArray export_xml_style(const Graph& graph);
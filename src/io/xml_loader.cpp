@@ -28,12 +28,36 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "xml_loader_v2.hpp"
 #include "xml_loader_v3.hpp"
 #include "xml_loader_v4.hpp"
+#include "knot_snapshot.hpp"
 #include <QBuffer>
+#include <QCache>
+#include <QMutex>
+#include <QFileInfo>
+#include <QDateTime>
+#include "trace.hpp"
 
 typedef XML_Loader_v4 XML_Loader_current;
 
+/**
+ * \brief Contents of a knot file, with the file state they were read from
+ */
+struct Cached_Knot : public Knot_Snapshot
+{
+    QDateTime           modified;
+    qint64              size;
+
+    explicit Cached_Knot(const Graph& graph)
+        : Knot_Snapshot(graph), size(0)
+    {}
+};
+
+/// Cost is the number of items, keeps up to a few hundred small knots
+static QCache<QString,Cached_Knot> knot_cache(16384);
+static QMutex knot_cache_mutex;
+
 void import_xml_style(QString style, Graph& graph)
 {
+    TRACE_SCOPE("import_xml_style");
     QByteArray output(style.toUtf8());
     QBuffer buffer(&output);
     buffer.open(QIODevice::ReadOnly);
@@ -43,6 +67,7 @@ void import_xml_style(QString style, Graph& graph)
 
 bool import_xml(QIODevice &file, Graph& graph)
 {
+    TRACE_SCOPE("import_xml");
     if ( !file.isOpen() && !file.open(QIODevice::ReadOnly|QIODevice::Text))
     {
         return false;
@@ -72,3 +97,47 @@ bool import_xml(QIODevice &file, Graph& graph)
 
     return false;
 }
+
+bool import_xml(QString file_name, Graph &graph)
+{
+    TRACE_SCOPE("import_xml file");
+    QFileInfo info(file_name);
+    QString key = info.canonicalFilePath();
+    if ( key.isEmpty() )
+        return false;
+
+    QMutexLocker lock(&knot_cache_mutex);
+
+    Cached_Knot* cached = knot_cache.object(key);
+    if ( cached && cached->modified == info.lastModified() && cached->size == info.size() )
+    {
+        cached->copy_to(graph);
+        return true;
+    }
+    lock.unlock();
+
+    Graph loaded;
+    QFile file(key);
+    if ( !import_xml(file,loaded) )
+        return false;
+
+    cached = new Cached_Knot(loaded);
+    cached->modified = info.lastModified();
+    cached->size = info.size();
+    cached->copy_to(graph);
+
+    foreach ( Edge* e, loaded.edges() )
+        delete e;
+    foreach ( Node* n, loaded.nodes() )
+        delete n;
+
+    lock.relock();
+    knot_cache.insert(key,cached,1+cached->node_count()+cached->edge_count());
+    return true;
+}
+
+void clear_xml_cache()
+{
+    QMutexLocker lock(&knot_cache_mutex);
+    knot_cache.clear();
+}
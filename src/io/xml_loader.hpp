@@ -32,6 +32,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 bool import_xml(QIODevice& file, Graph& graph);
 
+/**
+ * \brief Load a knot file, parsing it only if it has changed
+ *
+ * Parsed files are kept in a process-wide cache keyed by canonical path and
+ * modification time, loading the same file again only copies the cached
+ * nodes and edges into \p graph.
+ *
+ * \note Safe to be called from script workers
+ */
+bool import_xml(QString file_name, Graph& graph);
+
+/**
+ * \brief Discard the knots cached by import_xml(QString,Graph&)
+ *
+ * Needed when styles referenced by the cached knots are destroyed.
+ */
+void clear_xml_cache();
+
 void import_xml_style(QString style, Graph& graph);
 
 #endif // XML_LOADER_HPP
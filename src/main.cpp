@@ -24,39 +24,114 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 */
 #include <QApplication>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "main_window.hpp"
 #include "resource_manager.hpp"
 #include "edge_type.hpp"
 #include "command_line.hpp"
+#include "startup_profile.hpp"
+#include "trace.hpp"
+#include <iostream>
 
-
-int main(int argc, char *argv[])
+/**
+ * \brief Records a trace while in scope and saves it on destruction
+ *
+ * Covers every return from main()
+ */
+class Trace_Recording
 {
-    QApplication a(argc, argv);
+    QString file_name;
+
+public:
+    explicit Trace_Recording(const QString& file_name) : file_name(file_name)
+    {
+        if ( !file_name.isEmpty() )
+            Trace::instance().start();
+    }
+
+    ~Trace_Recording()
+    {
+        if ( file_name.isEmpty() )
+            return;
+        Trace::instance().stop();
+        if ( !Trace::instance().save(file_name) )
+            std::cerr << "Error while writing " << file_name.toStdString() << std::endl;
+    }
+};
 
-    resource_manager().register_cusp_shape(new Cusp_Pointed);
-    resource_manager().register_cusp_shape(new Cusp_Rounded);
-    resource_manager().register_cusp_shape(new Cusp_Polygonal);
-    resource_manager().register_cusp_shape(new Cusp_Ogee);
 
-    resource_manager().register_edge_type(new Edge_Normal);
-    resource_manager().register_edge_type(new Edge_Inverted);
-    resource_manager().register_edge_type(new Edge_Wall);
-    resource_manager().register_edge_type(new Edge_Hole);
+int main(int argc, char *argv[])
+{
+    bool profile = Command_Line::profile_startup(argc,argv);
+    if ( profile )
+        Startup_Profile::instance().enable();
 
-    resource_manager().initialize();
+    Trace_Recording trace(Command_Line::trace_file(argc,argv));
 
+    Startup_Timer app_timer("QApplication");
+    QApplication a(argc, argv);
+    app_timer.stop();
+
+    {
+        Startup_Timer timer("Built-in types");
+        resource_manager().register_cusp_shape(new Cusp_Pointed);
+        resource_manager().register_cusp_shape(new Cusp_Rounded);
+        resource_manager().register_cusp_shape(new Cusp_Polygonal);
+        resource_manager().register_cusp_shape(new Cusp_Ogee);
+
+        resource_manager().register_edge_type(new Edge_Normal);
+        resource_manager().register_edge_type(new Edge_Inverted);
+        resource_manager().register_edge_type(new Edge_Wall);
+        resource_manager().register_edge_type(new Edge_Hole);
+    }
+
+    {
+        Startup_Timer timer("Resources");
+        resource_manager().initialize();
+    }
+
+    Startup_Timer cmd_timer("Command line");
     Command_Line cmd(argc, argv);
+    cmd_timer.stop();
 
     if ( !cmd.load_ui() )
+    {
+        if ( profile )
+            Startup_Profile::instance().print(std::cout);
         return 0;
+    }
 
-
+    Startup_Timer window_timer("Main_Window");
     Main_Window mw;
     mw.show();
+    window_timer.stop();
+
+    {
+        Startup_Timer timer("Open files");
+        mw.open_files(cmd.files());
+        // Wait for the files so their loading is part of the profile
+        while ( profile && mw.loading_files() )
+            a.processEvents(QEventLoop::WaitForMoreEvents);
+    }
+
+    if ( profile )
+    {
+        {
+            Startup_Timer timer("First frame");
+            // Wake up regularly so a view that is never painted can't hang here
+            QTimer tick;
+            tick.start(50);
+            QElapsedTimer waited;
+            waited.start();
+            while ( !Startup_Profile::instance().frame_painted() && waited.elapsed() < 10000 )
+                a.processEvents(QEventLoop::WaitForMoreEvents);
+        }
+        Startup_Profile::instance().print(std::cout);
+        return 0;
+    }
 
-    foreach(QString s, cmd.files())
-        mw.create_tab(s);
+    mw.recover_files();
 
     return a.exec();
 }
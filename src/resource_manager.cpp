@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QApplication>
 #include <QStyle>
 #include <QNetworkRequest>
+#include "startup_profile.hpp"
 
 
 
@@ -43,9 +44,35 @@ void Resource_Manager::initialize(QString default_lang_code)
     // Clean up
     connect(qApp,SIGNAL(aboutToQuit()),pointer(),SLOT(save_settings()));
 
-
     // Initialize Icon theme
+    {
+        Startup_Timer timer("Icon theme");
+        init_icon_theme();
+    }
+
+    // Translation
+    {
+        Startup_Timer timer("Translations");
+        init_translations(default_lang_code);
+    }
+
+    // Scripting and plugins
+    {
+        Startup_Timer timer("Scripting");
+        script.initialize();
+    }
 
+    //network
+    m_network_access_manager = new QNetworkAccessManager;
+
+
+    // Load Settings: note after load_plugins
+    Startup_Timer timer("Settings");
+    settings.load_config();
+}
+
+void Resource_Manager::init_icon_theme()
+{
     QIcon::setThemeSearchPaths(
 #ifdef DEBUG
                 QStringList()
@@ -55,9 +82,10 @@ void Resource_Manager::initialize(QString default_lang_code)
                  << program.data("img/icons") );
 
     QIcon::setThemeName("knotter-icons");
+}
 
-    // Translation
-
+void Resource_Manager::init_translations(QString default_lang_code)
+{
     if ( !default_lang_code.isEmpty() )
     {
         QString name = language_name(default_lang_code);
@@ -85,15 +113,6 @@ void Resource_Manager::initialize(QString default_lang_code)
     }
 
     change_lang_code(QLocale::system().name());
-
-    script.initialize();
-
-    //network
-    m_network_access_manager = new QNetworkAccessManager;
-
-
-    // Load Settings: note after load_plugins
-    settings.load_config();
 }
 
 Resource_Manager::~Resource_Manager()
@@ -225,13 +244,30 @@ void Resource_Manager::save_settings()
 
 void Resource_Manager::register_edge_type(Edge_Type *type)
 {
+    if ( edge_type_set.contains(type) )
+        return;
     m_edge_types.push_back(type);
+    edge_type_set.insert(type);
+    QString name = type->machine_name();
+    if ( !edge_type_names.contains(name) )
+        edge_type_names.insert(name,type);
     emit edge_types_changed();
 }
 
 void Resource_Manager::remove_edge_type(Edge_Type *type)
 {
-    m_edge_types.removeOne(type);
+    if ( !m_edge_types.removeOne(type) )
+        return;
+
+    edge_type_set.remove(type);
+    // Another type with the same name may take its place, removals are rare
+    edge_type_names.clear();
+    foreach ( Edge_Type* et, m_edge_types )
+    {
+        QString name = et->machine_name();
+        if ( !edge_type_names.contains(name) )
+            edge_type_names.insert(name,et);
+    }
     emit edge_types_changed();
 }
 
@@ -269,21 +305,35 @@ Edge_Type *Resource_Manager::prev_edge_type(Edge_Type *type)
 
 Edge_Type *Resource_Manager::edge_type_from_machine_name(QString name)
 {
-    foreach(Edge_Type* st, m_edge_types )
-        if ( st->machine_name() == name )
-            return st;
-    return default_edge_type();
+    Edge_Type* type = edge_type_names.value(name);
+    return type ? type : default_edge_type();
 }
 
 void Resource_Manager::register_cusp_shape(Cusp_Shape *style)
 {
+    if ( cusp_shape_set.contains(style) )
+        return;
     m_cusp_shapes.push_back(style);
+    cusp_shape_set.insert(style);
+    QString name = style->machine_name();
+    if ( !cusp_shape_names.contains(name) )
+        cusp_shape_names.insert(name,style);
     emit cusp_shapes_changed();
 }
 
 void Resource_Manager::remove_cusp_shape(Cusp_Shape *shape)
 {
-    m_cusp_shapes.removeOne(shape);
+    if ( !m_cusp_shapes.removeOne(shape) )
+        return;
+
+    cusp_shape_set.remove(shape);
+    cusp_shape_names.clear();
+    foreach ( Cusp_Shape* cs, m_cusp_shapes )
+    {
+        QString name = cs->machine_name();
+        if ( !cusp_shape_names.contains(name) )
+            cusp_shape_names.insert(name,cs);
+    }
     emit cusp_shapes_changed();
 }
 
@@ -296,10 +346,8 @@ Cusp_Shape *Resource_Manager::default_cusp_shape()
 
 Cusp_Shape *Resource_Manager::cusp_shape_from_machine_name(QString name)
 {
-    foreach(Cusp_Shape* st, m_cusp_shapes )
-        if ( st->machine_name() == name )
-            return st;
-    return default_cusp_shape();
+    Cusp_Shape* shape = cusp_shape_names.value(name);
+    return shape ? shape : default_cusp_shape();
 }
 
 
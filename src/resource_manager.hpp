@@ -27,6 +27,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define RESOURCE_MANAGER_HPP
 
 #include <QObject>
+#include <QHash>
+#include <QSet>
 #include "settings.hpp"
 #include <QTranslator>
 #include "c++.hpp"
@@ -55,10 +57,18 @@ private:
 
     QList<Edge_Type*>  m_edge_types;
     QList<Cusp_Shape*> m_cusp_shapes;
+    /// Lookup tables kept in sync with m_edge_types and m_cusp_shapes
+    QSet<const Edge_Type*>          edge_type_set;
+    QSet<const Cusp_Shape*>         cusp_shape_set;
+    QHash<QString,Edge_Type*>       edge_type_names;    ///< First registered type for each machine name
+    QHash<QString,Cusp_Shape*>      cusp_shape_names;   ///< First registered shape for each machine name
 
 
     QNetworkAccessManager* m_network_access_manager;
 
+    void init_icon_theme();
+    void init_translations(QString default_lang_code);
+
 public:
     Settings         settings;
     Application_Info program;
@@ -128,6 +138,9 @@ public:
 
     QList<Edge_Type*> edge_types() { return m_edge_types; }
 
+    /// Whether \p type is registered, in constant time
+    bool has_edge_type(const Edge_Type* type) const { return edge_type_set.contains(type); }
+
     /**
      *  \brief Cycle edge styles
      *
@@ -149,7 +162,7 @@ public:
     /**
      *  \brief Get edge style from its machine-readable name
      *
-     *  Scans every register style to check a match to the given name,
+     *  Looks up the first registered style matching the given name,
      *  if none is found, the default style is returned.
      *
      *  Resurns NULL only if there are no registered styles
@@ -176,12 +189,15 @@ public:
 
     QList<Cusp_Shape*> cusp_shapes() { return m_cusp_shapes; }
 
+    /// Whether \p shape is registered, in constant time
+    bool has_cusp_shape(const Cusp_Shape* shape) const { return cusp_shape_set.contains(shape); }
+
     Cusp_Shape* default_cusp_shape();
     /**
      *  \brief Get cusp shape from its machine-readable name
      *
-     *  Scans every register style to check a match to the given name,
-     *  if none is found, the default style is returned.
+     *  Looks up the first registered shape matching the given name,
+     *  if none is found, the default shape is returned.
      *
      *  Resurns NULL only if there are no registered styles
      */
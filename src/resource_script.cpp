@@ -34,45 +34,52 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "edge_scripted.hpp"
 #include "json_stuff.hpp"
 #include "resource_manager.hpp"
+#include "xml_loader.hpp"
+#include "startup_profile.hpp"
+#include "trace.hpp"
+#include "script_worker.hpp"
+#include <QApplication>
 
 
 void Resource_Script::initialize()
 {
 
     // Scripting
-    m_script_engine = new QScriptEngine; // needs to be initialized only after qApp is created
-    m_script_engine->setProcessEventsInterval(500);
-    QScriptEngine* engine = m_script_engine; // shorer to write
-    current_context = nullptr;
-    m_script_engine_agent = new QScriptEngineAgent(engine);
-    engine->setAgent(m_script_engine_agent);
-    script_timeout = new QTimer;
-    script_timeout->setSingleShot(true);
-    connect(script_timeout,SIGNAL(timeout()),this,SLOT(abort_script()));
-
-    qRegisterMetaType<Script_Point>("Script_Point");
-    qScriptRegisterMetaType(engine, point_to_script, point_from_script);
-    qRegisterMetaType<Script_Line>("Script_Line");
-    qScriptRegisterMetaType(engine, line_to_script, line_from_script);
-    qRegisterMetaType<Script_Graph>("Script_Graph");
-    qScriptRegisterMetaType(engine, graph_to_script, graph_from_script);
-    qRegisterMetaType<Script_Polygon>("Script_Polygon");
-    qScriptRegisterMetaType(engine, polygon_to_script, polygon_from_script);
-    qRegisterMetaType<Script_Color>("Script_Color");
-    qScriptRegisterMetaType(engine, color_to_script, color_from_script);
-
-    qScriptRegisterMetaType(engine,edge_handle_to_script,edge_handle_from_script);
-
+    {
+        Startup_Timer timer("Script engine");
+        m_script_engine = new QScriptEngine; // needs to be initialized only after qApp is created
+        m_script_engine->setProcessEventsInterval(500);
+        QScriptEngine* engine = m_script_engine; // shorer to write
+        current_context = nullptr;
+        m_script_engine_agent = new QScriptEngineAgent(engine);
+        engine->setAgent(m_script_engine_agent);
+        m_profiler = new Script_Profiler(engine);
+        script_timeout = new QTimer;
+        script_timeout->setSingleShot(true);
+        connect(script_timeout,SIGNAL(timeout()),this,SLOT(abort_script()));
+        // running threads must not outlive the application
+        connect(qApp,SIGNAL(aboutToQuit()),this,SLOT(stop_workers()));
+
+        register_types(engine);
+    }
 
 
     //plugins
-    load_plugins();
+    {
+        Startup_Timer timer("Plugins");
+        plugin_manifests = Plugin_Manifest_Cache(
+            resource_manager().program.writable_data_directory("plugin_manifests.cache"));
+        load_plugins();
+    }
     emit plugins_changed();
 
 }
 
 Resource_Script::~Resource_Script()
 {
+    qDeleteAll(graph_wrappers);
+    graph_wrappers.clear();
+
     foreach ( Plugin* p, m_plugins)
         delete p;
 
@@ -81,6 +88,40 @@ Resource_Script::~Resource_Script()
 }
 
 
+Script_Graph *Resource_Script::graph_wrapper(const Graph *graph)
+{
+    QMutexLocker lock(&graph_wrappers_mutex);
+    QHash<const Graph*,Script_Graph*>::iterator it = graph_wrappers.find(graph);
+    if ( it == graph_wrappers.end() )
+        it = graph_wrappers.insert(graph,new Script_Graph);
+    it.value()->refresh_styles();
+    return it.value();
+}
+
+void Resource_Script::release_graph_wrapper(const Graph *graph)
+{
+    QMutexLocker lock(&graph_wrappers_mutex);
+    delete graph_wrappers.take(graph);
+}
+
+
+void Resource_Script::enable_profiler(bool enable)
+{
+    if ( m_script_engine->isEvaluating() || enable == m_profiler->is_enabled() )
+        return;
+
+    if ( enable )
+    {
+        m_profiler->clear();
+        m_script_engine->setAgent(m_profiler);
+    }
+    else
+    {
+        m_script_engine->setAgent(m_script_engine_agent);
+    }
+    m_profiler->set_enabled(enable);
+}
+
 void Resource_Script::load_plugins(QString directory)
 {
     QDir plugin_dir = QDir(directory);
@@ -105,6 +146,7 @@ void Resource_Script::load_plugins()
     {
         load_plugins(plugin_dir_name);
     }
+    plugin_manifests.save();
 }
 
 void Resource_Script::reload_plugins()
@@ -117,6 +159,8 @@ void Resource_Script::reload_plugins()
         delete p;
     }
     m_plugins.clear();
+    // cached knots can reference the deleted cusp and edge types
+    clear_xml_cache();
     load_plugins();
 
     foreach(Plugin* p,m_plugins )
@@ -146,43 +190,66 @@ QScriptContext* Resource_Script::script_context()
 
         current_context = engine->pushContext();
 
-        engine->globalObject().setProperty("Point", engine->newFunction(build_point));
-        ///sengine->globalObject().setProperty("diff", engine->newFunction(subtract_points));
-        engine->globalObject().setProperty("opposite", engine->newFunction(opposite_point));
-        engine->globalObject().setProperty("distance", engine->newFunction(distance));
+        set_globals(engine,true);
+    }
+    return current_context;
+}
 
-        engine->globalObject().setProperty("Line", engine->newFunction(build_line));
+void Resource_Script::register_types(QScriptEngine *engine)
+{
+    qRegisterMetaType<Script_Point>("Script_Point");
+    qScriptRegisterMetaType(engine, point_to_script, point_from_script);
+    qRegisterMetaType<Script_Line>("Script_Line");
+    qScriptRegisterMetaType(engine, line_to_script, line_from_script);
+    qRegisterMetaType<Script_Graph>("Script_Graph");
+    qScriptRegisterMetaType(engine, graph_to_script, graph_from_script);
+    qRegisterMetaType<Script_Polygon>("Script_Polygon");
+    qScriptRegisterMetaType(engine, polygon_to_script, polygon_from_script);
+    qRegisterMetaType<Script_Color>("Script_Color");
+    qScriptRegisterMetaType(engine, color_to_script, color_from_script);
+
+    qScriptRegisterMetaType(engine,edge_handle_to_script,edge_handle_from_script);
+}
+
+void Resource_Script::set_globals(QScriptEngine *engine, bool gui_thread)
+{
+    engine->globalObject().setProperty("Point", engine->newFunction(build_point));
+    ///sengine->globalObject().setProperty("diff", engine->newFunction(subtract_points));
+    engine->globalObject().setProperty("opposite", engine->newFunction(opposite_point));
+    engine->globalObject().setProperty("distance", engine->newFunction(distance));
 
+    engine->globalObject().setProperty("Line", engine->newFunction(build_line));
 
-        engine->globalObject().setProperty( "print", engine->newFunction( script_print ) );
 
-        engine->globalObject().setProperty( "knotter",
-            engine->newQObject(new Script_Knotter,QScriptEngine::ScriptOwnership));
-        engine->globalObject().setProperty( "system",
-            engine->newQObject(new Script_System,QScriptEngine::ScriptOwnership));
-        engine->globalObject().setProperty("run_script", engine->newFunction(script_run_script));
+    engine->globalObject().setProperty( "print", engine->newFunction( script_print ) );
 
-        engine->globalObject().setProperty("Graph", engine->newFunction(build_graph));
+    engine->globalObject().setProperty( "knotter",
+        engine->newQObject(new Script_Knotter,QScriptEngine::ScriptOwnership));
+    engine->globalObject().setProperty( "system",
+        engine->newQObject(new Script_System,QScriptEngine::ScriptOwnership));
+    engine->globalObject().setProperty("run_script", engine->newFunction(script_run_script));
 
+    engine->globalObject().setProperty("Graph", engine->newFunction(build_graph));
 
-        engine->globalObject().setProperty("Polygon", engine->newFunction(build_polygon));
 
+    engine->globalObject().setProperty("Polygon", engine->newFunction(build_polygon));
 
-        engine->globalObject().setProperty("Color", engine->newFunction(build_color));
-        engine->globalObject().setProperty("rgb", engine->newFunction(script_rgb));
-        engine->globalObject().setProperty("rgba", engine->newFunction(script_rgb));
-        engine->globalObject().setProperty("hsv", engine->newFunction(script_hsv));
-        engine->globalObject().setProperty("hsl", engine->newFunction(script_hsl));
-        engine->globalObject().setProperty("cmyk", engine->newFunction(script_cmyk));
 
+    engine->globalObject().setProperty("Color", engine->newFunction(build_color));
+    engine->globalObject().setProperty("rgb", engine->newFunction(script_rgb));
+    engine->globalObject().setProperty("rgba", engine->newFunction(script_rgb));
+    engine->globalObject().setProperty("hsv", engine->newFunction(script_hsv));
+    engine->globalObject().setProperty("hsl", engine->newFunction(script_hsl));
+    engine->globalObject().setProperty("cmyk", engine->newFunction(script_cmyk));
 
 
-        QScriptValue gui = m_script_engine->newObject();
+
+    if ( gui_thread )
+    {
+        QScriptValue gui = engine->newObject();
         gui.setProperty("table_widget",engine->newFunction(script_create_tablewidget_wrapper));
         engine->globalObject().setProperty( "gui",gui);
-
     }
-    return current_context;
 }
 
 void Resource_Script::param(QString name, QScriptValue value)
@@ -204,6 +271,7 @@ void Resource_Script::param(QString name, QObject* value,
 QScriptValue Resource_Script::execute(Plugin *source,
                                           QScriptValue *activation_object)
 {
+    TRACE_SCOPE("Resource_Script::execute plugin");
 
     script_context();
 
@@ -274,6 +342,7 @@ QScriptValue Resource_Script::execute(const QString &program,
                                           int lineNumber,
                                           QScriptValue *activation_object)
 {
+    TRACE_SCOPE("Resource_Script::execute");
     script_context();
     if ( resource_manager().settings.script_timeout() > 0 )
     {
@@ -310,13 +379,14 @@ QScriptValue Resource_Script::execute(const QString &program,
 
 void Resource_Script::load_plugin(QString filename)
 {
-    QFile file(filename);
-    if ( !file.open(QFile::Text|QFile::ReadOnly) )
+    bool readable = false;
+    QVariantMap manifest = plugin_manifests.manifest(filename,&readable);
+    if ( !readable )
         return;
 
 
     QString error;
-    Plugin *p = Plugin::from_file(file,&error);
+    Plugin *p = Plugin::from_data(manifest,filename,&error);
 
     if ( !p && error.isEmpty() )
         error = tr("Unknown error");
@@ -360,4 +430,35 @@ void Resource_Script::abort_script()
         }
         m_script_engine->abortEvaluation(v);
     }
+
+    foreach ( const QPointer<Script_Worker>& worker, workers )
+        if ( worker )
+            worker->abort();
+}
+
+void Resource_Script::start_worker(Script_Worker *worker)
+{
+    workers.removeAll(QPointer<Script_Worker>());
+    workers << worker;
+    worker->start();
+}
+
+void Resource_Script::stop_workers(const Knot_View *view)
+{
+    QList<QPointer<Script_Worker> > stopping = workers;
+    foreach ( const QPointer<Script_Worker>& worker, stopping )
+    {
+        if ( worker && ( !view || worker->target() == view ) )
+        {
+            worker->abort();
+            worker->wait();
+            delete worker;
+        }
+    }
+    workers.removeAll(QPointer<Script_Worker>());
+}
+
+void Resource_Script::stop_workers()
+{
+    stop_workers(nullptr);
 }
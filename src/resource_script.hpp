@@ -29,8 +29,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QObject>
 #include <QScriptEngine>
 #include "plugin.hpp"
+#include "plugin_manifest_cache.hpp"
 #include <QScriptEngineAgent>
+#include "script_profiler.hpp"
 #include <QTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+
+class Graph;
+class Script_Graph;
+class Script_Worker;
+class Knot_View;
 
 class Resource_Script : public QObject
 {
@@ -39,9 +49,14 @@ class Resource_Script : public QObject
 private:
     QScriptEngine *     m_script_engine;
     QList<Plugin*>      m_plugins;
+    Plugin_Manifest_Cache plugin_manifests; ///< Avoids parsing unchanged plugin files
     QScriptContext *    current_context;
     QScriptEngineAgent* m_script_engine_agent;
+    Script_Profiler*    m_profiler;
     QTimer*             script_timeout;
+    QHash<const Graph*,Script_Graph*> graph_wrappers; ///< Shared script views
+    QMutex              graph_wrappers_mutex; ///< Graphs can be destroyed by script workers
+    QList<QPointer<Script_Worker> > workers; ///< Workers started by start_worker()
 
 
     Resource_Script(){}
@@ -75,9 +90,29 @@ public:
     /*/// Get a reference to the internal script engine
     static QScriptEngine* script_engine() { return singleton.m_script_engine; }*/
 
+    /// Register the Knotter types to a script engine
+    static void register_types(QScriptEngine* engine);
+
+    /**
+     * \brief Add the Knotter global objects and functions to a script engine
+     * \param gui_thread Whether to add objects that can only be used from the GUI thread
+     */
+    static void set_globals(QScriptEngine* engine, bool gui_thread);
+
     /// Get the script engine agent
     QScriptEngineAgent& script_engine_agent() { return *m_script_engine_agent; }
 
+    /// Get the script profiler
+    Script_Profiler& profiler() { return *m_profiler; }
+
+    /**
+     * \brief Start or stop profiling scripts
+     *
+     * Starting discards the data collected in previous sessions.
+     * Does nothing while a script is being executed.
+     */
+    void enable_profiler(bool enable);
+
     /**
      * \brief Get or create a new script context
      *
@@ -122,13 +157,49 @@ public:
 
     void emit_output(QString s) { emit output(s); }
 
+    void emit_error(QString file,int line,QString msg, QStringList trace)
+    { emit error(file,line,msg,trace); }
+
+    /**
+     * \brief Get the shared script view of a graph
+     *
+     * The view is created on the first request and reused afterwards,
+     * wrappers for nodes and edges are created only when a script reaches them
+     * and are dropped when the wrapped object is destroyed.
+     * Wrapped styles are refreshed from the graph on each call.
+     */
+    Script_Graph* graph_wrapper(const Graph* graph);
+    /**
+     * \brief Remove the shared script view of a graph
+     * \note Called when the graph is destroyed
+     */
+    void release_graph_wrapper(const Graph* graph);
+
+    /**
+     * \brief Start a worker and keep track of it until it's deleted
+     */
+    void start_worker(Script_Worker* worker);
+
+    /**
+     * \brief Abort the workers running on the given view and wait for them
+     *
+     * The workers are deleted without applying their changes
+     */
+    void stop_workers(const Knot_View* view);
+
 public slots:
 
     /**
-     * \brief Terminates currently running scripts
+     * \brief Terminates currently running scripts, including workers
      */
     void abort_script();
 
+    /**
+     * \brief Abort all the workers and wait for them
+     * \note Called when the application is about to quit
+     */
+    void stop_workers();
+
 signals:
     /// Emitted when an error has to be added to the plugin log
     void error(QString file,int line,QString msg, QStringList trace);
@@ -31,32 +31,95 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "traversal_info.hpp"
 #include "resource_manager.hpp"
 
+/// Slots of the variables available to declarative cusps
+enum Cusp_Slot
+{
+    SLOT_INPUT_EDGE     = 0, ///< input_edge.p1, .p2, .length, .angle
+    SLOT_OUTPUT_EDGE    = SLOT_INPUT_EDGE+4,
+    SLOT_START_HANDLE   = SLOT_OUTPUT_EDGE+4,
+    SLOT_FINISH_HANDLE  = SLOT_START_HANDLE+4,
+    SLOT_NODE_POINT     = SLOT_FINISH_HANDLE+4,
+    SLOT_CUSP_POINT,
+    SLOT_ANGLE,
+    SLOT_HANDLE_LENGTH,
+    SLOT_CUSP_ANGLE,
+    SLOT_CUSP_DISTANCE,
+    SLOT_DIRECTION
+};
+
+/// Variables available to declarative cusps, same names as the script parameters
+static Geometry_Symbols cusp_symbols()
+{
+    Geometry_Symbols symbols;
+    symbols.declare_line("input_edge");
+    symbols.declare_line("output_edge");
+    symbols.declare_line("start_handle");
+    symbols.declare_line("finish_handle");
+    symbols.declare("node_point",Geometry_Symbols::POINT);
+    symbols.declare("cusp_point",Geometry_Symbols::POINT);
+    symbols.declare("angle",Geometry_Symbols::SCALAR);
+    symbols.declare("handle_length",Geometry_Symbols::SCALAR);
+    symbols.declare("cusp_angle",Geometry_Symbols::SCALAR);
+    symbols.declare("cusp_distance",Geometry_Symbols::SCALAR);
+    symbols.declare("direction",Geometry_Symbols::SCALAR);
+    return symbols;
+}
+
 QString Cusp_Scripted::machine_name() const
 {
     return plugin->string_data("plugin_shortname");
 }
 
+bool Cusp_Scripted::load_geometry(QString *error)
+{
+    return geometry.compile(plugin->metadata()["geometry"],cusp_symbols(),
+                            QList<Geometry_Symbols::Type>(),error);
+}
+
 void Cusp_Scripted::draw_joint(Path_Builder &path, const Traversal_Info &ti, const Node_Style &style) const
 {
-    Script_Line input_edge ( ti.node->pos(), ti.in.edge->other(ti.node)->pos() );
-    Script_Line output_edge ( ti.node->pos(), ti.out.edge->other(ti.node)->pos() );
-    Script_Line start_handle = ti.in.edge->style().edge_type->handle(ti.in.edge,ti.in.handle);
-    Script_Line finish_handle = ti.out.edge->style().edge_type->handle(ti.out.edge,ti.out.handle);
-    Script_Point cusp_point = this->cusp_point(ti,style.cusp_distance);
-    Script_Point node_point = ti.node->pos();
-
-
-    resource_manager().script.param_template("input_edge",input_edge);
-    resource_manager().script.param_template("output_edge",output_edge);
-    resource_manager().script.param_template("start_handle",start_handle);
-    resource_manager().script.param_template("finish_handle",finish_handle);
-    resource_manager().script.param_template("node_point",node_point);
-    resource_manager().script.param_template("cusp_point",cusp_point);
+    QLineF input_edge ( ti.node->pos(), ti.in.edge->other(ti.node)->pos() );
+    QLineF output_edge ( ti.node->pos(), ti.out.edge->other(ti.node)->pos() );
+    QLineF start_handle = ti.in.edge->handle(ti.in.handle);
+    QLineF finish_handle = ti.out.edge->handle(ti.out.handle);
+    QPointF cusp_point = this->cusp_point(ti,style.cusp_distance);
+    QPointF node_point = ti.node->pos();
+    int direction = ti.handside == Traversal_Info::LEFT ? -1 : +1;
+
+    resource_manager().script.profiler().count_callback(plugin,"draw_joint");
+
+    if ( !geometry.is_empty() )
+    {
+        QVector<Geometry_Value> values(geometry.size());
+        Geometry_Symbols::set_line(values,SLOT_INPUT_EDGE,input_edge);
+        Geometry_Symbols::set_line(values,SLOT_OUTPUT_EDGE,output_edge);
+        Geometry_Symbols::set_line(values,SLOT_START_HANDLE,start_handle);
+        Geometry_Symbols::set_line(values,SLOT_FINISH_HANDLE,finish_handle);
+        values[SLOT_NODE_POINT] = node_point;
+        values[SLOT_CUSP_POINT] = cusp_point;
+        values[SLOT_ANGLE] = ti.angle_delta;
+        values[SLOT_HANDLE_LENGTH] = style.handle_length;
+        values[SLOT_CUSP_ANGLE] = style.cusp_angle;
+        values[SLOT_CUSP_DISTANCE] = style.cusp_distance;
+        values[SLOT_DIRECTION] = direction;
+
+        if ( !geometry.evaluate(values,&path,nullptr) )
+            default_path(path,start_handle,finish_handle);
+        return;
+    }
+
+
+    resource_manager().script.param_template("input_edge",Script_Line(input_edge));
+    resource_manager().script.param_template("output_edge",Script_Line(output_edge));
+    resource_manager().script.param_template("start_handle",Script_Line(start_handle));
+    resource_manager().script.param_template("finish_handle",Script_Line(finish_handle));
+    resource_manager().script.param_template("node_point",Script_Point(node_point));
+    resource_manager().script.param_template("cusp_point",Script_Point(cusp_point));
     resource_manager().script.param_template("angle",ti.angle_delta);
     resource_manager().script.param_template("handle_length",style.handle_length);
     resource_manager().script.param_template("cusp_angle",style.cusp_angle);
     resource_manager().script.param_template("cusp_distance",style.cusp_distance);
-    resource_manager().script.param_template("direction", ti.handside == Traversal_Info::LEFT ? -1 : +1 );
+    resource_manager().script.param_template("direction",direction);
 
 
     Script_Path_Builder script_path(&path);
@@ -29,11 +29,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "node_cusp_shape.hpp"
 #include "plugin_cusp.hpp"
+#include "geometry_template.hpp"
 
 class Cusp_Scripted : public Cusp_Shape
 {
 private:
-    Plugin_Cusp* plugin;
+    Plugin_Cusp*      plugin;
+    Geometry_Template geometry; ///< Native implementation, empty for scripted cusps
 public:
     Cusp_Scripted(Plugin_Cusp* plugin) : plugin(plugin) {}
 
@@ -46,6 +48,16 @@ public:
     void draw_joint ( Path_Builder& path,
                         const Traversal_Info& ti,
                         const Node_Style& style ) const override;
+
+    /**
+     * \brief Compile the declarative geometry found in the plugin metadata
+     *
+     * After this, draw_joint() won't run the plugin script
+     *
+     * \param[out] error Error message
+     * \return \c true on success
+     */
+    bool load_geometry(QString* error);
 };
 
 #endif // CUSP_SCRIPTED_HPP
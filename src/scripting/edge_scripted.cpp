@@ -29,11 +29,101 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "script_path_builder.hpp"
 #include "script_graph.hpp"
 
+/// Slots of the variables available to declarative crossings
+enum Edge_Slot
+{
+    SLOT_EDGE       = 0, ///< edge.p1, .p2, .length, .angle
+    SLOT_MIDPOINT   = SLOT_EDGE+4,
+    SLOT_HANDLE,
+    SLOT_CURVE,
+    SLOT_GAP,
+    SLOT_SLIDE
+};
+
+/**
+ * \brief Variables available to declarative crossings
+ * \param handle_functions Whether to provide handle_p1() and handle_p2(),
+ *        these call Edge_Scripted::handle() so they must not be available
+ *        to the handle template itself
+ */
+static Geometry_Symbols edge_symbols(bool handle_functions)
+{
+    Geometry_Symbols symbols;
+    symbols.declare_line("edge");
+    symbols.declare("edge.midpoint",Geometry_Symbols::POINT);
+    symbols.declare("handle",Geometry_Symbols::SCALAR);
+    symbols.declare("style.curve",Geometry_Symbols::SCALAR);
+    symbols.declare("style.gap",Geometry_Symbols::SCALAR);
+    symbols.declare("style.slide",Geometry_Symbols::SCALAR);
+    symbols.declare_constant("NO_HANDLE",Edge::NO_HANDLE);
+    symbols.declare_constant("TOP_LEFT",Edge::TOP_LEFT);
+    symbols.declare_constant("TOP_RIGHT",Edge::TOP_RIGHT);
+    symbols.declare_constant("BOTTOM_LEFT",Edge::BOTTOM_LEFT);
+    symbols.declare_constant("BOTTOM_RIGHT",Edge::BOTTOM_RIGHT);
+    symbols.enable_handle_functions(handle_functions);
+    return symbols;
+}
+
+/// Fill the variables for edge_symbols()
+static void edge_values(const Edge* edge, Edge::Handle handle,
+                        QVector<Geometry_Value>& values)
+{
+    const Edge_Style& style = edge->defaulted_style();
+    Geometry_Symbols::set_line(values,SLOT_EDGE,edge->to_line());
+    values[SLOT_MIDPOINT] = edge->midpoint();
+    values[SLOT_HANDLE] = double(handle);
+    values[SLOT_CURVE] = style.handle_length;
+    values[SLOT_GAP] = style.crossing_distance;
+    values[SLOT_SLIDE] = style.edge_slide;
+}
+
+/// Provides handle_p1() and handle_p2() to declarative crossings
+class Edge_Scripted_Handles : public Geometry_Callback
+{
+    const Edge*      edge;
+
+public:
+    explicit Edge_Scripted_Handles(const Edge* edge)
+        : edge(edge) {}
+
+    QLineF handle_line(int handle) const override
+    {
+        return edge->handle(Edge::Handle(handle));
+    }
+};
+
+
 Edge_Scripted::Edge_Scripted(Plugin_Crossing *plugin)
     : plugin(plugin)
 {
 }
 
+bool Edge_Scripted::load_geometry(QString *error)
+{
+    QVariantMap geometry = plugin->metadata()["geometry"].toMap();
+
+    QList<Geometry_Symbols::Type> handle_result;
+    handle_result << Geometry_Symbols::POINT << Geometry_Symbols::POINT;
+    if ( !handle_geometry.compile(geometry["handle"],edge_symbols(false),
+                                  handle_result,error) )
+    {
+        *error = QObject::tr("handle: %1").arg(*error);
+        return false;
+    }
+
+    QList<Geometry_Symbols::Type> traverse_result;
+    traverse_result << Geometry_Symbols::SCALAR;
+    if ( !traverse_geometry.compile(geometry["traverse"],edge_symbols(true),
+                                    traverse_result,error) )
+    {
+        *error = QObject::tr("traverse: %1").arg(*error);
+        handle_geometry = Geometry_Template();
+        return false;
+    }
+
+    return true;
+}
+
 
 void Edge_Scripted::setup_script() const
 {
@@ -54,6 +144,19 @@ void Edge_Scripted::setup_script() const
 
 Edge::Handle Edge_Scripted::traverse(Edge *edge, Edge::Handle handle, Path_Builder &path) const
 {
+    resource_manager().script.profiler().count_callback(plugin,"traverse");
+
+    if ( !traverse_geometry.is_empty() )
+    {
+        QVector<Geometry_Value> values(traverse_geometry.size());
+        edge_values(edge,handle,values);
+        QVector<Geometry_Value> result;
+        Edge_Scripted_Handles handles(edge);
+        if ( !traverse_geometry.evaluate(values,&path,&result,&handles) )
+            return Edge::NO_HANDLE;
+        return Edge::Handle(int(result[0].x));
+    }
+
     // run common script
     setup_script();
 
@@ -64,9 +167,8 @@ Edge::Handle Edge_Scripted::traverse(Edge *edge, Edge::Handle handle, Path_Build
     Script_Path_Builder script_path(&path);
     resource_manager().script.param("path",&script_path);
 
-    Script_Graph script_graph(*edge->graph());
-    Script_Edge script_edge(edge,&script_graph);
-    resource_manager().script.param("edge",&script_edge);
+    Script_Graph* script_graph = resource_manager().script.graph_wrapper(edge->graph());
+    resource_manager().script.param("edge",script_graph->script_edge(edge));
 
     Script_Edge_Style script_style(edge->defaulted_style());
     resource_manager().script.param("style",&script_style);
@@ -84,16 +186,28 @@ Edge::Handle Edge_Scripted::traverse(Edge *edge, Edge::Handle handle, Path_Build
 
 QLineF Edge_Scripted::handle(const Edge *edge, Edge::Handle handle) const
 {
+    resource_manager().script.profiler().count_callback(plugin,"handle");
+
+    if ( !handle_geometry.is_empty() )
+    {
+        QVector<Geometry_Value> values(handle_geometry.size());
+        edge_values(edge,handle,values);
+        QVector<Geometry_Value> result;
+        Edge_Scripted_Handles handles(edge);
+        if ( !handle_geometry.evaluate(values,nullptr,&result,&handles) )
+            return QLineF();
+        return QLineF(result[0].point(),result[1].point());
+    }
+
     // run common script
     setup_script();
 
     // set up params
     resource_manager().script.param_template("handle",handle);
 
-    Script_Graph script_graph(*edge->graph());
+    Script_Graph* script_graph = resource_manager().script.graph_wrapper(edge->graph());
     /// \warning const_cast
-    Script_Edge script_edge(const_cast<Edge*>(edge),&script_graph);
-    resource_manager().script.param("edge",&script_edge);
+    resource_manager().script.param("edge",script_graph->script_edge(const_cast<Edge*>(edge)));
 
     Script_Edge_Style script_style(edge->defaulted_style());
     resource_manager().script.param("style",&script_style);
@@ -29,12 +29,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "edge_type.hpp"
 #include "plugin_crossing.hpp"
+#include "geometry_template.hpp"
 #include <QScriptEngine>
 
 class Edge_Scripted : public Edge_Type
 {
 private:
     Plugin_Crossing *plugin;
+    /// Native implementation of handle(), empty for scripted crossings
+    Geometry_Template handle_geometry;
+    /// Native implementation of traverse(), empty for scripted crossings
+    Geometry_Template traverse_geometry;
 
 public:
     Edge_Scripted(Plugin_Crossing *plugin);
@@ -55,6 +60,18 @@ public:
     QString machine_name() const override;
     QIcon icon() const override;
 
+    /**
+     * \brief Compile the declarative geometry found in the plugin metadata
+     *
+     * The geometry is an object with the keys \c "handle" and \c "traverse"
+     * whose results are the two points of the handle line and the next handle.
+     * After this, the plugin script won't be used.
+     *
+     * \param[out] error Error message
+     * \return \c true on success
+     */
+    bool load_geometry(QString* error);
+
 private:
     /**
      * \brief Executes the common script file and preserves the local context
@@ -0,0 +1,957 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "geometry_template.hpp"
+#include "point_math.hpp"
+#include <QVarLengthArray>
+#include <QStringList>
+#include <QObject>
+#include <QRegExp>
+
+/// Shorthands for the function table
+enum { S = Geometry_Symbols::SCALAR, P = Geometry_Symbols::POINT };
+
+enum Geometry_Function
+{
+    FUNCTION_POINT, FUNCTION_POLAR,
+    FUNCTION_DISTANCE, FUNCTION_LENGTH, FUNCTION_ANGLE,
+    FUNCTION_UNIT, FUNCTION_ROTATE, FUNCTION_LERP,
+    FUNCTION_SIN, FUNCTION_COS, FUNCTION_SQRT, FUNCTION_ABS,
+    FUNCTION_MIN, FUNCTION_MAX, FUNCTION_DEG2RAD, FUNCTION_RAD2DEG,
+    FUNCTION_HANDLE_P1, FUNCTION_HANDLE_P2,
+    FUNCTION_COUNT
+};
+
+static const struct
+{
+    const char* name;
+    int         argc;
+    int         args[3];
+    int         result;
+} functions[FUNCTION_COUNT] = {
+    { "point",      2, { S, S }, P },
+    { "polar",      2, { S, S }, P },
+    { "distance",   2, { P, P }, S },
+    { "length",     1, { P },    S },
+    { "angle",      2, { P, P }, S },
+    { "unit",       1, { P },    P },
+    { "rotate",     2, { P, S }, P },
+    { "lerp",       3, { P, P, S }, P },
+    { "sin",        1, { S },    S },
+    { "cos",        1, { S },    S },
+    { "sqrt",       1, { S },    S },
+    { "abs",        1, { S },    S },
+    { "min",        2, { S, S }, S },
+    { "max",        2, { S, S }, S },
+    { "deg2rad",    1, { S },    S },
+    { "rad2deg",    1, { S },    S },
+    { "handle_p1",  1, { S },    P },
+    { "handle_p2",  1, { S },    P },
+};
+
+/**
+ * \brief Call a native function
+ *
+ * Arguments are the top values of the stack and are replaced by the result
+ *
+ * \return New top of the stack
+ */
+static int call_function(int function, Geometry_Value* stack, int top,
+                         const Geometry_Callback* callback)
+{
+    Geometry_Value* arg = stack + top - functions[function].argc + 1;
+    Geometry_Value result;
+    switch ( function )
+    {
+        case FUNCTION_POINT:
+            result = Geometry_Value(arg[0].x,arg[1].x);
+            break;
+        case FUNCTION_POLAR:
+        {
+            double rad = deg2rad(arg[1].x);
+            result = Geometry_Value(arg[0].x*qCos(rad),-arg[0].x*qSin(rad));
+            break;
+        }
+        case FUNCTION_DISTANCE:
+            result = point_distance(arg[0].point(),arg[1].point());
+            break;
+        case FUNCTION_LENGTH:
+            result = qSqrt(arg[0].x*arg[0].x+arg[0].y*arg[0].y);
+            break;
+        case FUNCTION_ANGLE:
+            result = QLineF(arg[0].point(),arg[1].point()).angle();
+            break;
+        case FUNCTION_UNIT:
+        {
+            double length = qSqrt(arg[0].x*arg[0].x+arg[0].y*arg[0].y);
+            if ( length > 0 )
+                result = Geometry_Value(arg[0].x/length,arg[0].y/length);
+            break;
+        }
+        case FUNCTION_ROTATE:
+        {
+            // same orientation as QLineF::angle()
+            double rad = deg2rad(arg[1].x);
+            double c = qCos(rad), s = qSin(rad);
+            result = Geometry_Value( arg[0].x*c + arg[0].y*s,
+                                    -arg[0].x*s + arg[0].y*c );
+            break;
+        }
+        case FUNCTION_LERP:
+            result = Geometry_Value(arg[0].x+(arg[1].x-arg[0].x)*arg[2].x,
+                                    arg[0].y+(arg[1].y-arg[0].y)*arg[2].x);
+            break;
+        case FUNCTION_SIN:
+            result = qSin(arg[0].x);
+            break;
+        case FUNCTION_COS:
+            result = qCos(arg[0].x);
+            break;
+        case FUNCTION_SQRT:
+            result = qSqrt(arg[0].x);
+            break;
+        case FUNCTION_ABS:
+            result = qAbs(arg[0].x);
+            break;
+        case FUNCTION_MIN:
+            result = qMin(arg[0].x,arg[1].x);
+            break;
+        case FUNCTION_MAX:
+            result = qMax(arg[0].x,arg[1].x);
+            break;
+        case FUNCTION_DEG2RAD:
+            result = double(deg2rad(arg[0].x));
+            break;
+        case FUNCTION_RAD2DEG:
+            result = double(rad2deg(arg[0].x));
+            break;
+        case FUNCTION_HANDLE_P1:
+            if ( callback )
+                result = callback->handle_line(int(arg[0].x)).p1();
+            break;
+        case FUNCTION_HANDLE_P2:
+            if ( callback )
+                result = callback->handle_line(int(arg[0].x)).p2();
+            break;
+    }
+    *arg = result;
+    return arg - stack;
+}
+
+
+Geometry_Symbols::Geometry_Symbols()
+    : slots(0), m_handle_functions(false)
+{
+    declare_constant("PI",pi());
+}
+
+int Geometry_Symbols::declare(QString name, Geometry_Symbols::Type type)
+{
+    Symbol sym;
+    sym.slot = slots++;
+    sym.type = type;
+    sym.value = 0;
+    symbols[name] = sym;
+
+    QStringList parts = name.split('.');
+    parts.pop_back();
+    QString prefix;
+    foreach ( QString part, parts )
+    {
+        prefix += prefix.isEmpty() ? part : "."+part;
+        prefixes.insert(prefix);
+    }
+
+    return sym.slot;
+}
+
+int Geometry_Symbols::declare_line(QString name)
+{
+    int slot = declare(name+".p1",POINT);
+    declare(name+".p2",POINT);
+    declare(name+".length",SCALAR);
+    declare(name+".angle",SCALAR);
+    return slot;
+}
+
+void Geometry_Symbols::declare_constant(QString name, double value)
+{
+    Symbol sym;
+    sym.slot = -1;
+    sym.type = SCALAR;
+    sym.value = value;
+    symbols[name] = sym;
+}
+
+void Geometry_Symbols::set_line(QVector<Geometry_Value> &values, int slot, QLineF line)
+{
+    values[slot] = line.p1();
+    values[slot+1] = line.p2();
+    values[slot+2] = line.length();
+    values[slot+3] = line.angle();
+}
+
+
+/**
+ * \brief Recursive descent parser for Geometry_Expression
+ */
+class Geometry_Parser
+{
+    enum Token_Type { END, NUMBER, IDENTIFIER, OPERATOR, INVALID };
+
+    QString                 source;
+    int                     pos;
+    const Geometry_Symbols& symbols;
+    QString                 m_error;
+
+    Token_Type              token;
+    QString                 token_text;
+    double                  token_value;
+
+    Geometry_Expression*    output;
+    int                     stack_size;
+
+public:
+    Geometry_Parser(QString source, const Geometry_Symbols& symbols)
+        : source(source), pos(0), symbols(symbols),
+          token(END), token_value(0), output(nullptr), stack_size(0)
+    {
+        next();
+    }
+
+    QString error() const { return m_error; }
+
+    bool at_end() const { return token == END; }
+
+    /// Parse a full expression starting from the current token
+    bool parse(Geometry_Expression& expression)
+    {
+        output = &expression;
+        expression.code.clear();
+        expression.max_stack = 1;
+        stack_size = 0;
+        return parse_or(expression.m_type);
+    }
+
+    /// Consume a comma, returns \c false if the current token isn't a comma
+    bool comma()
+    {
+        return accept(",");
+    }
+
+private:
+
+    void next()
+    {
+        while ( pos < source.size() && source[pos].isSpace() )
+            pos++;
+
+        token_text.clear();
+        if ( pos >= source.size() )
+        {
+            token = END;
+            return;
+        }
+
+        QChar c = source[pos];
+        int start = pos;
+        if ( c.isDigit() || ( c == '.' && pos+1 < source.size() && source[pos+1].isDigit() ) )
+        {
+            while ( pos < source.size() && ( source[pos].isDigit() || source[pos] == '.' ) )
+                pos++;
+            if ( pos < source.size() && ( source[pos] == 'e' || source[pos] == 'E' ) )
+            {
+                int exponent = pos+1;
+                if ( exponent < source.size() && ( source[exponent] == '+' || source[exponent] == '-' ) )
+                    exponent++;
+                if ( exponent < source.size() && source[exponent].isDigit() )
+                {
+                    pos = exponent;
+                    while ( pos < source.size() && source[pos].isDigit() )
+                        pos++;
+                }
+            }
+            token_text = source.mid(start,pos-start);
+            bool ok = false;
+            token_value = token_text.toDouble(&ok);
+            token = ok ? NUMBER : INVALID;
+        }
+        else if ( c.isLetter() || c == '_' )
+        {
+            while ( pos < source.size() && ( source[pos].isLetterOrNumber() || source[pos] == '_' ) )
+                pos++;
+            token_text = source.mid(start,pos-start);
+            token = IDENTIFIER;
+        }
+        else
+        {
+            static const char* const operators[] = {
+                "<=", ">=", "==", "!=", "&&", "||",
+                "+", "-", "*", "/", "(", ")", ",", ".", "<", ">", "!",
+                nullptr
+            };
+            for ( int i = 0; operators[i]; i++ )
+            {
+                QLatin1String op(operators[i]);
+                int len = qstrlen(operators[i]);
+                if ( source.mid(pos,len) == op )
+                {
+                    token = OPERATOR;
+                    token_text = op;
+                    pos += len;
+                    return;
+                }
+            }
+            token = INVALID;
+            token_text = c;
+            pos++;
+        }
+    }
+
+    bool is_operator(const char* op) const
+    {
+        return token == OPERATOR && token_text == QLatin1String(op);
+    }
+
+    bool accept(const char* op)
+    {
+        if ( is_operator(op) )
+        {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    bool fail(QString message)
+    {
+        if ( m_error.isEmpty() )
+        {
+            if ( token == END )
+                m_error = QObject::tr("%1 at end of expression").arg(message);
+            else
+                m_error = QObject::tr("%1 near \"%2\"").arg(message).arg(token_text);
+        }
+        return false;
+    }
+
+    bool fail_types(QString op)
+    {
+        return fail(QObject::tr("Invalid operand types for \"%1\"").arg(op));
+    }
+
+    /**
+     * \brief Append an instruction
+     * \param stack_change How many values are added (or removed) from the stack
+     */
+    void emit_code(Geometry_Expression::Opcode op, int stack_change,
+                   int arg = 0, double value = 0)
+    {
+        Geometry_Expression::Instruction instruction;
+        instruction.op = op;
+        instruction.arg = arg;
+        instruction.value = value;
+        output->code.push_back(instruction);
+        stack_size += stack_change;
+        if ( stack_size > output->max_stack )
+            output->max_stack = stack_size;
+    }
+
+    bool parse_or(Geometry_Symbols::Type& type)
+    {
+        if ( !parse_and(type) )
+            return false;
+        while ( is_operator("||") )
+        {
+            next();
+            Geometry_Symbols::Type rhs;
+            if ( !parse_and(rhs) )
+                return false;
+            if ( type != Geometry_Symbols::SCALAR || rhs != Geometry_Symbols::SCALAR )
+                return fail_types("||");
+            emit_code(Geometry_Expression::OR,-1);
+        }
+        return true;
+    }
+
+    bool parse_and(Geometry_Symbols::Type& type)
+    {
+        if ( !parse_comparison(type) )
+            return false;
+        while ( is_operator("&&") )
+        {
+            next();
+            Geometry_Symbols::Type rhs;
+            if ( !parse_comparison(rhs) )
+                return false;
+            if ( type != Geometry_Symbols::SCALAR || rhs != Geometry_Symbols::SCALAR )
+                return fail_types("&&");
+            emit_code(Geometry_Expression::AND,-1);
+        }
+        return true;
+    }
+
+    bool parse_comparison(Geometry_Symbols::Type& type)
+    {
+        if ( !parse_additive(type) )
+            return false;
+
+        static const char* const operators[] = { "<", ">", "<=", ">=", "==", "!=" };
+        static const Geometry_Expression::Opcode opcodes[] = {
+            Geometry_Expression::LESS, Geometry_Expression::GREATER,
+            Geometry_Expression::LESS_EQUAL, Geometry_Expression::GREATER_EQUAL,
+            Geometry_Expression::EQUAL, Geometry_Expression::NOT_EQUAL
+        };
+
+        for ( int i = 0; i < 6; i++ )
+        {
+            if ( is_operator(operators[i]) )
+            {
+                next();
+                Geometry_Symbols::Type rhs;
+                if ( !parse_additive(rhs) )
+                    return false;
+                if ( type != Geometry_Symbols::SCALAR || rhs != Geometry_Symbols::SCALAR )
+                    return fail_types(operators[i]);
+                emit_code(opcodes[i],-1);
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool parse_additive(Geometry_Symbols::Type& type)
+    {
+        if ( !parse_multiplicative(type) )
+            return false;
+        while ( is_operator("+") || is_operator("-") )
+        {
+            bool add = is_operator("+");
+            next();
+            Geometry_Symbols::Type rhs;
+            if ( !parse_multiplicative(rhs) )
+                return false;
+            if ( type != rhs )
+                return fail_types(add ? "+" : "-");
+            if ( type == Geometry_Symbols::POINT )
+                emit_code(add ? Geometry_Expression::ADD_POINT : Geometry_Expression::SUB_POINT,-1);
+            else
+                emit_code(add ? Geometry_Expression::ADD : Geometry_Expression::SUB,-1);
+        }
+        return true;
+    }
+
+    bool parse_multiplicative(Geometry_Symbols::Type& type)
+    {
+        if ( !parse_unary(type) )
+            return false;
+        while ( is_operator("*") || is_operator("/") )
+        {
+            bool mul = is_operator("*");
+            next();
+            Geometry_Symbols::Type rhs;
+            if ( !parse_unary(rhs) )
+                return false;
+
+            if ( type == Geometry_Symbols::SCALAR && rhs == Geometry_Symbols::SCALAR )
+                emit_code(mul ? Geometry_Expression::MUL : Geometry_Expression::DIV,-1);
+            else if ( type == Geometry_Symbols::POINT && rhs == Geometry_Symbols::SCALAR )
+                emit_code(mul ? Geometry_Expression::MUL_POINT : Geometry_Expression::DIV_POINT,-1);
+            else if ( mul && type == Geometry_Symbols::SCALAR && rhs == Geometry_Symbols::POINT )
+            {
+                // arg = 1: scalar is below the point
+                emit_code(Geometry_Expression::MUL_POINT,-1,1);
+                type = Geometry_Symbols::POINT;
+            }
+            else
+                return fail_types(mul ? "*" : "/");
+        }
+        return true;
+    }
+
+    bool parse_unary(Geometry_Symbols::Type& type)
+    {
+        if ( accept("-") )
+        {
+            if ( !parse_unary(type) )
+                return false;
+            emit_code(type == Geometry_Symbols::POINT ?
+                          Geometry_Expression::NEG_POINT : Geometry_Expression::NEG, 0);
+            return true;
+        }
+        else if ( accept("+") )
+        {
+            return parse_unary(type);
+        }
+        else if ( accept("!") )
+        {
+            if ( !parse_unary(type) )
+                return false;
+            if ( type != Geometry_Symbols::SCALAR )
+                return fail_types("!");
+            emit_code(Geometry_Expression::NOT,0);
+            return true;
+        }
+        return parse_postfix(type);
+    }
+
+    bool parse_postfix(Geometry_Symbols::Type& type)
+    {
+        if ( !parse_primary(type) )
+            return false;
+        while ( accept(".") )
+        {
+            if ( token != IDENTIFIER || ( token_text != "x" && token_text != "y" ) )
+                return fail(QObject::tr("Expected \"x\" or \"y\""));
+            if ( type != Geometry_Symbols::POINT )
+                return fail(QObject::tr("Member access on a scalar value"));
+            emit_code(token_text == "x" ? Geometry_Expression::GET_X : Geometry_Expression::GET_Y, 0);
+            type = Geometry_Symbols::SCALAR;
+            next();
+        }
+        return true;
+    }
+
+    bool parse_primary(Geometry_Symbols::Type& type)
+    {
+        if ( token == NUMBER )
+        {
+            emit_code(Geometry_Expression::PUSH,1,0,token_value);
+            type = Geometry_Symbols::SCALAR;
+            next();
+            return true;
+        }
+
+        if ( accept("(") )
+        {
+            if ( !parse_or(type) )
+                return false;
+            if ( !accept(")") )
+                return fail(QObject::tr("Expected \")\""));
+            return true;
+        }
+
+        if ( token != IDENTIFIER )
+            return fail(QObject::tr("Unexpected token"));
+
+        QString name = token_text;
+        next();
+
+        if ( accept("(") )
+            return parse_call(name,type);
+
+        // dotted names, eg: start_handle.p1
+        while ( !symbols.contains(name) && symbols.is_prefix(name) && accept(".") )
+        {
+            if ( token != IDENTIFIER )
+                return fail(QObject::tr("Expected a name"));
+            name += "."+token_text;
+            next();
+        }
+
+        if ( !symbols.contains(name) )
+            return fail(QObject::tr("Unknown name \"%1\"").arg(name));
+
+        type = symbols.type(name);
+        if ( symbols.is_constant(name) )
+            emit_code(Geometry_Expression::PUSH,1,0,symbols.constant(name));
+        else
+            emit_code(Geometry_Expression::LOAD,1,symbols.slot(name));
+        return true;
+    }
+
+    bool parse_call(QString name, Geometry_Symbols::Type& type)
+    {
+        int function = 0;
+        while ( function < FUNCTION_COUNT && name != QLatin1String(functions[function].name) )
+            function++;
+        if ( function == FUNCTION_COUNT )
+            return fail(QObject::tr("Unknown function \"%1\"").arg(name));
+        if ( ( function == FUNCTION_HANDLE_P1 || function == FUNCTION_HANDLE_P2 ) &&
+                !symbols.handle_functions() )
+            return fail(QObject::tr("Function \"%1\" is not available here").arg(name));
+
+        int argc = 0;
+        if ( !accept(")") )
+        {
+            do
+            {
+                Geometry_Symbols::Type arg_type;
+                if ( !parse_or(arg_type) )
+                    return false;
+                if ( argc >= functions[function].argc ||
+                        arg_type != functions[function].args[argc] )
+                    return fail(QObject::tr("Invalid arguments for \"%1\"").arg(name));
+                argc++;
+            }
+            while ( accept(",") );
+
+            if ( !accept(")") )
+                return fail(QObject::tr("Expected \")\""));
+        }
+
+        if ( argc != functions[function].argc )
+            return fail(QObject::tr("Wrong number of arguments for \"%1\"").arg(name));
+
+        emit_code(Geometry_Expression::CALL,1-argc,function);
+        type = Geometry_Symbols::Type(functions[function].result);
+        return true;
+    }
+};
+
+
+Geometry_Expression::Geometry_Expression()
+    : m_type(Geometry_Symbols::SCALAR), max_stack(1)
+{
+}
+
+bool Geometry_Expression::compile(QString source, const Geometry_Symbols &symbols, QString *error)
+{
+    Geometry_Parser parser(source,symbols);
+    if ( !parser.parse(*this) )
+    {
+        *error = parser.error();
+        return false;
+    }
+    if ( !parser.at_end() )
+    {
+        *error = QObject::tr("Unexpected text after expression in \"%1\"").arg(source);
+        return false;
+    }
+    return true;
+}
+
+bool Geometry_Expression::compile_list(QString source, const Geometry_Symbols &symbols,
+                                       QVector<Geometry_Expression> &output, QString *error)
+{
+    output.clear();
+    Geometry_Parser parser(source,symbols);
+    while ( !parser.at_end() )
+    {
+        Geometry_Expression expression;
+        if ( !parser.parse(expression) )
+        {
+            *error = parser.error();
+            return false;
+        }
+        output.push_back(expression);
+
+        if ( !parser.at_end() && !parser.comma() )
+        {
+            *error = QObject::tr("Expected \",\" in \"%1\"").arg(source);
+            return false;
+        }
+    }
+    return true;
+}
+
+Geometry_Value Geometry_Expression::evaluate(const QVector<Geometry_Value> &values,
+                                             const Geometry_Callback *callback) const
+{
+    QVarLengthArray<Geometry_Value,16> stack(max_stack);
+    Geometry_Value* s = stack.data();
+    int top = -1;
+
+    const Instruction* end = code.constData()+code.size();
+    for ( const Instruction* i = code.constData(); i != end; ++i )
+    {
+        switch ( i->op )
+        {
+            case PUSH:
+                s[++top] = Geometry_Value(i->value);
+                break;
+            case LOAD:
+                s[++top] = values[i->arg];
+                break;
+            case ADD:
+                s[top-1].x += s[top].x;
+                top--;
+                break;
+            case SUB:
+                s[top-1].x -= s[top].x;
+                top--;
+                break;
+            case MUL:
+                s[top-1].x *= s[top].x;
+                top--;
+                break;
+            case DIV:
+                s[top-1].x /= s[top].x;
+                top--;
+                break;
+            case ADD_POINT:
+                s[top-1].x += s[top].x;
+                s[top-1].y += s[top].y;
+                top--;
+                break;
+            case SUB_POINT:
+                s[top-1].x -= s[top].x;
+                s[top-1].y -= s[top].y;
+                top--;
+                break;
+            case MUL_POINT:
+                if ( i->arg )
+                    s[top-1] = Geometry_Value(s[top].x*s[top-1].x, s[top].y*s[top-1].x);
+                else
+                    s[top-1] = Geometry_Value(s[top-1].x*s[top].x, s[top-1].y*s[top].x);
+                top--;
+                break;
+            case DIV_POINT:
+                s[top-1].x /= s[top].x;
+                s[top-1].y /= s[top].x;
+                top--;
+                break;
+            case NEG:
+                s[top].x = -s[top].x;
+                break;
+            case NEG_POINT:
+                s[top].x = -s[top].x;
+                s[top].y = -s[top].y;
+                break;
+            case LESS:
+                s[top-1] = Geometry_Value( s[top-1].x < s[top].x );
+                top--;
+                break;
+            case GREATER:
+                s[top-1] = Geometry_Value( s[top-1].x > s[top].x );
+                top--;
+                break;
+            case LESS_EQUAL:
+                s[top-1] = Geometry_Value( s[top-1].x <= s[top].x );
+                top--;
+                break;
+            case GREATER_EQUAL:
+                s[top-1] = Geometry_Value( s[top-1].x >= s[top].x );
+                top--;
+                break;
+            case EQUAL:
+                s[top-1] = Geometry_Value( qFuzzyCompare(s[top-1].x,s[top].x) );
+                top--;
+                break;
+            case NOT_EQUAL:
+                s[top-1] = Geometry_Value( !qFuzzyCompare(s[top-1].x,s[top].x) );
+                top--;
+                break;
+            case AND:
+                s[top-1] = Geometry_Value( s[top-1].x != 0 && s[top].x != 0 );
+                top--;
+                break;
+            case OR:
+                s[top-1] = Geometry_Value( s[top-1].x != 0 || s[top].x != 0 );
+                top--;
+                break;
+            case NOT:
+                s[top] = Geometry_Value( s[top].x == 0 );
+                break;
+            case GET_X:
+                s[top] = Geometry_Value( s[top].x );
+                break;
+            case GET_Y:
+                s[top] = Geometry_Value( s[top].y );
+                break;
+            case CALL:
+                top = call_function(i->arg,s,top,callback);
+                break;
+        }
+    }
+
+    return top >= 0 ? s[top] : Geometry_Value();
+}
+
+
+Geometry_Template::Geometry_Template()
+    : slots(0)
+{
+}
+
+bool Geometry_Template::compile(const QVariant &source, const Geometry_Symbols &symbols,
+                                const QList<Geometry_Symbols::Type> &result_types,
+                                QString *error)
+{
+    cases.clear();
+    slots = symbols.size();
+
+    QVariantList case_list = source.toList();
+    if ( case_list.isEmpty() && source.type() == QVariant::Map )
+        case_list << source;
+    if ( case_list.isEmpty() )
+    {
+        *error = QObject::tr("No geometry cases");
+        return false;
+    }
+
+    QRegExp identifier("[a-zA-Z_][a-zA-Z0-9_]*");
+    QString message;
+
+    for ( int i = 0; i < case_list.size(); i++ )
+    {
+        QVariantMap data = case_list[i].toMap();
+        Geometry_Symbols case_symbols = symbols;
+        Case c;
+
+        c.conditional = data.contains("when");
+        if ( c.conditional )
+        {
+            if ( !c.condition.compile(data["when"].toString(),case_symbols,&message) )
+                break;
+            if ( c.condition.type() != Geometry_Symbols::SCALAR )
+            {
+                message = QObject::tr("Condition must be a scalar value");
+                break;
+            }
+        }
+
+        foreach ( QString definition, data["let"].toStringList() )
+        {
+            int eq = definition.indexOf('=');
+            QString name = definition.left(eq).trimmed();
+            if ( eq < 0 || !identifier.exactMatch(name) )
+            {
+                message = QObject::tr("Invalid definition \"%1\"").arg(definition);
+                break;
+            }
+            if ( case_symbols.contains(name) )
+            {
+                message = QObject::tr("\"%1\" is already defined").arg(name);
+                break;
+            }
+            Definition def;
+            if ( !def.value.compile(definition.mid(eq+1),case_symbols,&message) )
+                break;
+            def.slot = case_symbols.declare(name,def.value.type());
+            c.definitions.push_back(def);
+        }
+        if ( !message.isEmpty() )
+            break;
+
+        foreach ( QString command, data["path"].toStringList() )
+        {
+            command = command.trimmed();
+            QString name = command.section(' ',0,0);
+            Path_Command path_command;
+            if ( name == "line" )
+                path_command.points = 2;
+            else if ( name == "quad" )
+                path_command.points = 3;
+            else if ( name == "cubic" )
+                path_command.points = 4;
+            else
+            {
+                message = QObject::tr("Unknown path command \"%1\"").arg(name);
+                break;
+            }
+
+            if ( !Geometry_Expression::compile_list(command.mid(name.size()),
+                        case_symbols, path_command.arguments, &message) )
+                break;
+
+            bool valid = path_command.arguments.size() == path_command.points;
+            for ( int j = 0; valid && j < path_command.arguments.size(); j++ )
+                valid = path_command.arguments[j].type() == Geometry_Symbols::POINT;
+            if ( !valid )
+            {
+                message = QObject::tr("\"%1\" requires %2 points").arg(name).arg(path_command.points);
+                break;
+            }
+
+            c.path.push_back(path_command);
+        }
+        if ( !message.isEmpty() )
+            break;
+
+        if ( !result_types.isEmpty() )
+        {
+            if ( !Geometry_Expression::compile_list(data["result"].toString(),
+                                                    case_symbols, c.result, &message) )
+                break;
+
+            bool valid = c.result.size() == result_types.size();
+            for ( int j = 0; valid && j < c.result.size(); j++ )
+                valid = c.result[j].type() == result_types[j];
+            if ( !valid )
+            {
+                message = QObject::tr("Invalid result");
+                break;
+            }
+        }
+
+        slots = qMax(slots,case_symbols.size());
+        cases.push_back(c);
+    }
+
+    if ( !message.isEmpty() )
+    {
+        *error = QObject::tr("Geometry case %1: %2").arg(cases.size()+1).arg(message);
+        cases.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool Geometry_Template::evaluate(QVector<Geometry_Value> &values, Path_Builder *path,
+                                 QVector<Geometry_Value> *result,
+                                 const Geometry_Callback *callback) const
+{
+    for ( int i = 0; i < cases.size(); i++ )
+    {
+        const Case& c = cases[i];
+        if ( c.conditional && c.condition.evaluate(values,callback).x == 0 )
+            continue;
+
+        for ( int j = 0; j < c.definitions.size(); j++ )
+            values[c.definitions[j].slot] = c.definitions[j].value.evaluate(values,callback);
+
+        if ( path )
+        {
+            for ( int j = 0; j < c.path.size(); j++ )
+            {
+                const Path_Command& command = c.path[j];
+                QPointF p[4];
+                for ( int k = 0; k < command.points; k++ )
+                    p[k] = command.arguments[k].evaluate(values,callback).point();
+
+                if ( command.points == 2 )
+                    path->add_line(p[0],p[1]);
+                else if ( command.points == 3 )
+                    path->add_quad(p[0],p[1],p[2]);
+                else
+                    path->add_cubic(p[0],p[1],p[2],p[3]);
+            }
+        }
+
+        if ( result )
+        {
+            result->resize(c.result.size());
+            for ( int j = 0; j < c.result.size(); j++ )
+                (*result)[j] = c.result[j].evaluate(values,callback);
+        }
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,284 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef GEOMETRY_TEMPLATE_HPP
+#define GEOMETRY_TEMPLATE_HPP
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QVariant>
+#include <QLineF>
+#include "path_builder.hpp"
+#include "c++.hpp"
+
+/**
+ * \brief Value handled by Geometry_Expression
+ *
+ * Scalars only use \c x
+ */
+struct Geometry_Value
+{
+    double x;
+    double y;
+
+    Geometry_Value(double x = 0, double y = 0) : x(x), y(y) {}
+    Geometry_Value(QPointF p) : x(p.x()), y(p.y()) {}
+
+    QPointF point() const { return QPointF(x,y); }
+};
+
+/**
+ * \brief Provides values that need to be computed on demand
+ */
+class Geometry_Callback
+{
+public:
+    virtual ~Geometry_Callback(){}
+    /// Get the handle line of the edge being rendered
+    virtual QLineF handle_line(int handle) const = 0;
+};
+
+/**
+ * \brief Names available to geometry expressions
+ *
+ * Every variable is assigned to a slot, values are passed to the evaluation
+ * as a vector indexed by slot.
+ */
+class Geometry_Symbols
+{
+public:
+    enum Type { SCALAR, POINT };
+
+private:
+    struct Symbol
+    {
+        int    slot;    ///< Slot index, -1 for constants
+        Type   type;
+        double value;   ///< Constant value
+    };
+
+    QHash<QString,Symbol> symbols;
+    QSet<QString>         prefixes; ///< Leading parts of dotted names
+    int                   slots;
+    bool                  m_handle_functions;
+
+public:
+    Geometry_Symbols();
+
+    /**
+     * \brief Declare a variable
+     * \return The slot assigned to the variable
+     */
+    int declare(QString name, Type type);
+
+    /**
+     * \brief Declare the variables for a line
+     *
+     * They are \c name.p1, \c name.p2, \c name.length and \c name.angle
+     * in this order.
+     *
+     * \return The slot assigned to \c name.p1
+     */
+    int declare_line(QString name);
+
+    /// Declare a named constant
+    void declare_constant(QString name, double value);
+
+    bool contains(QString name) const { return symbols.contains(name); }
+    bool is_prefix(QString name) const { return prefixes.contains(name); }
+    bool is_constant(QString name) const { return symbols[name].slot < 0; }
+    int slot(QString name) const { return symbols[name].slot; }
+    Type type(QString name) const { return symbols[name].type; }
+    double constant(QString name) const { return symbols[name].value; }
+
+    /// Number of slots needed to hold all the variables
+    int size() const { return slots; }
+
+    /// Whether handle_p1() and handle_p2() can be used
+    bool handle_functions() const { return m_handle_functions; }
+    void enable_handle_functions(bool enable) { m_handle_functions = enable; }
+
+    /**
+     * \brief Set the values of a line declared with declare_line()
+     */
+    static void set_line(QVector<Geometry_Value>& values, int slot, QLineF line);
+};
+
+/**
+ * \brief Arithmetic expression compiled to a sequence of native instructions
+ *
+ * Expressions use the usual infix operators ( + - * / < > <= >= == != && || ! ),
+ * .x and .y to access point components, the variables declared in the
+ * Geometry_Symbols and the following functions:
+ *  - point(x,y), polar(length,angle)
+ *  - distance(a,b), length(p), angle(a,b), unit(p), rotate(p,angle), lerp(a,b,t)
+ *  - sin, cos, sqrt, abs, min, max, deg2rad, rad2deg
+ *  - handle_p1(h), handle_p2(h) (crossings only)
+ *
+ * Angles are in degrees, with the same orientation as QLineF::angle(),
+ * sin and cos take radians.
+ *
+ * Types are checked at compile time so evaluation never fails.
+ */
+class Geometry_Expression
+{
+    friend class Geometry_Parser;
+
+public:
+    enum Opcode
+    {
+        PUSH,                   ///< Push constant
+        LOAD,                   ///< Push variable
+        ADD, SUB, MUL, DIV,     ///< Scalar arithmetic
+        ADD_POINT, SUB_POINT,   ///< Point arithmetic
+        MUL_POINT, DIV_POINT,   ///< Point by scalar (scalar on top)
+        NEG, NEG_POINT,
+        LESS, GREATER, LESS_EQUAL, GREATER_EQUAL, EQUAL, NOT_EQUAL,
+        AND, OR, NOT,
+        GET_X, GET_Y,
+        CALL                    ///< Call native function
+    };
+
+    struct Instruction
+    {
+        Opcode op;
+        int    arg;     ///< Slot or function
+        double value;   ///< Constant
+    };
+
+private:
+    QVector<Instruction>   code;
+    Geometry_Symbols::Type m_type;
+    int                    max_stack;
+
+public:
+    Geometry_Expression();
+
+    /**
+     * \brief Compile a list of comma-separated expressions
+     * \param source        Source code
+     * \param symbols       Available names
+     * \param[out] output   Compiled expressions
+     * \param[out] error    Error message
+     * \return \c true on success
+     */
+    static bool compile_list(QString source, const Geometry_Symbols& symbols,
+                             QVector<Geometry_Expression>& output, QString* error);
+
+    /**
+     * \brief Compile a single expression
+     * \return \c true on success
+     */
+    bool compile(QString source, const Geometry_Symbols& symbols, QString* error);
+
+    Geometry_Symbols::Type type() const { return m_type; }
+
+    /**
+     * \brief Evaluate the expression
+     * \param values    Variable values, indexed by slot
+     * \param callback  Used by functions requiring extra information, can be \c nullptr
+     */
+    Geometry_Value evaluate(const QVector<Geometry_Value>& values,
+                            const Geometry_Callback* callback = nullptr) const;
+};
+
+/**
+ * \brief Declarative geometry description used by native cusp and crossing plugins
+ *
+ * A template is a list of cases, the first one whose \c "when" condition
+ * holds (or without condition) is used.
+ * Each case is an object with the following (optional) keys:
+ *  - \c "when"   Condition expression
+ *  - \c "let"    List of local definitions in the form <tt>name = expression</tt>
+ *  - \c "path"   List of path commands:
+ *                <tt>line a, b</tt>, <tt>quad a, b, c</tt> or <tt>cubic a, b, c, d</tt>
+ *  - \c "result" Comma-separated expressions returned to the caller
+ *
+ * \see Geometry_Expression for the expression syntax
+ */
+class Geometry_Template
+{
+    struct Definition
+    {
+        int                 slot;
+        Geometry_Expression value;
+    };
+
+    struct Path_Command
+    {
+        int                          points;     ///< 2 line, 3 quad, 4 cubic
+        QVector<Geometry_Expression> arguments;
+    };
+
+    struct Case
+    {
+        bool                         conditional;
+        Geometry_Expression          condition;
+        QVector<Definition>          definitions;
+        QVector<Path_Command>        path;
+        QVector<Geometry_Expression> result;
+    };
+
+    QVector<Case> cases;
+    int           slots;
+
+public:
+    Geometry_Template();
+
+    /**
+     * \brief Compile the template
+     * \param source        List of cases, as read from the plugin metadata
+     * \param symbols       Input variables
+     * \param result_types  Types expected in \c "result"
+     * \param[out] error    Error message
+     * \return \c true on success
+     */
+    bool compile(const QVariant& source, const Geometry_Symbols& symbols,
+                 const QList<Geometry_Symbols::Type>& result_types,
+                 QString* error);
+
+    bool is_empty() const { return cases.isEmpty(); }
+
+    /**
+     * \brief Number of slots needed by evaluate(), including local definitions
+     */
+    int size() const { return slots; }
+
+    /**
+     * \brief Evaluate the first matching case
+     * \param values        Variable values, must have size() elements
+     * \param[out] path     If not \c nullptr receives the path segments
+     * \param[out] result   If not \c nullptr receives the result values
+     * \param callback      Used by functions requiring extra information
+     * \return \c false if no case matched
+     */
+    bool evaluate(QVector<Geometry_Value>& values, Path_Builder* path,
+                  QVector<Geometry_Value>* result,
+                  const Geometry_Callback* callback = nullptr) const;
+};
+
+#endif // GEOMETRY_TEMPLATE_HPP
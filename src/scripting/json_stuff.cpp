@@ -40,14 +40,246 @@ QString json_escape(QString s)
     return '"'+s+'"';
 }
 
+/**
+ * \brief Recursive descent parser producing the same values as QScriptValue::toVariant
+ *
+ * Accepts the JavaScript extensions found in hand-written files:
+ * comments, single quoted strings, unquoted keys and trailing commas
+ */
+class Json_Parser
+{
+    const char* pos;
+    const char* end;
+    bool        error;
+
+public:
+    explicit Json_Parser(const QByteArray& data)
+        : pos(data.constData()), end(data.constData()+data.size()), error(false)
+    {}
+
+    QVariant parse()
+    {
+        QVariant value = parse_value();
+        skip_space();
+        if ( pos != end )
+            error = true;
+        return value;
+    }
+
+    bool failed() const { return error; }
+
+private:
+    void skip_space()
+    {
+        while ( pos < end )
+        {
+            if ( *pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r' )
+                pos++;
+            else if ( *pos == '/' && pos+1 < end && pos[1] == '/' )
+            {
+                while ( pos < end && *pos != '\n' )
+                    pos++;
+            }
+            else if ( *pos == '/' && pos+1 < end && pos[1] == '*' )
+            {
+                pos += 2;
+                while ( pos+1 < end && !(pos[0] == '*' && pos[1] == '/') )
+                    pos++;
+                pos = pos+1 < end ? pos+2 : end;
+            }
+            else
+                break;
+        }
+    }
+
+    bool accept(char c)
+    {
+        skip_space();
+        if ( pos < end && *pos == c )
+        {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    QVariant fail()
+    {
+        error = true;
+        pos = end;
+        return QVariant();
+    }
+
+    QVariant parse_value()
+    {
+        skip_space();
+        if ( pos >= end )
+            return fail();
+
+        if ( *pos == '{' )
+            return parse_object();
+        if ( *pos == '[' )
+            return parse_array();
+        if ( *pos == '"' || *pos == '\'' )
+            return parse_string();
+        if ( *pos == '-' || *pos == '+' || *pos == '.' || (*pos >= '0' && *pos <= '9') )
+            return parse_number();
+
+        QByteArray word = parse_identifier();
+        if ( word == "true" )
+            return true;
+        if ( word == "false" )
+            return false;
+        if ( word == "null" )
+            return QVariant();
+        return fail();
+    }
+
+    QVariant parse_object()
+    {
+        pos++; // {
+        QVariantMap map;
+        while ( !accept('}') )
+        {
+            skip_space();
+            if ( pos >= end )
+                return fail();
+            QString key = ( *pos == '"' || *pos == '\'' ) ?
+                parse_string() : QString::fromUtf8(parse_identifier());
+            if ( key.isEmpty() || !accept(':') )
+                return fail();
+            map[key] = parse_value();
+            if ( !accept(',') )
+            {
+                if ( !accept('}') )
+                    return fail();
+                break;
+            }
+        }
+        return map;
+    }
+
+    QVariant parse_array()
+    {
+        pos++; // [
+        QVariantList list;
+        while ( !accept(']') )
+        {
+            list.push_back(parse_value());
+            if ( !accept(',') )
+            {
+                if ( !accept(']') )
+                    return fail();
+                break;
+            }
+        }
+        return list;
+    }
+
+    QString parse_string()
+    {
+        char quote = *pos++;
+        QByteArray utf8;
+        QString result;
+        while ( pos < end && *pos != quote )
+        {
+            if ( *pos != '\\' )
+            {
+                utf8 += *pos++;
+                continue;
+            }
+
+            if ( ++pos >= end )
+                break;
+            char escaped = *pos++;
+            switch ( escaped )
+            {
+                case 'n': utf8 += '\n'; break;
+                case 't': utf8 += '\t'; break;
+                case 'r': utf8 += '\r'; break;
+                case 'b': utf8 += '\b'; break;
+                case 'f': utf8 += '\f'; break;
+                case 'u':
+                {
+                    if ( end - pos < 4 )
+                    {
+                        fail();
+                        return QString();
+                    }
+                    bool ok = false;
+                    ushort code = QByteArray(pos,4).toUShort(&ok,16);
+                    if ( !ok )
+                    {
+                        fail();
+                        return QString();
+                    }
+                    pos += 4;
+                    result += QString::fromUtf8(utf8);
+                    utf8.clear();
+                    result += QChar(code);
+                    break;
+                }
+                default: utf8 += escaped; break;
+            }
+        }
+
+        if ( pos >= end )
+        {
+            fail();
+            return QString();
+        }
+        pos++; // closing quote
+        return result + QString::fromUtf8(utf8);
+    }
+
+    QVariant parse_number()
+    {
+        const char* start = pos;
+        while ( pos < end && ( (*pos >= '0' && *pos <= '9') || *pos == '.' ||
+                *pos == 'e' || *pos == 'E' || *pos == '+' || *pos == '-' ) )
+            pos++;
+        bool ok = false;
+        double value = QByteArray(start,pos-start).toDouble(&ok);
+        if ( !ok )
+            return fail();
+        return value;
+    }
+
+    QByteArray parse_identifier()
+    {
+        skip_space();
+        const char* start = pos;
+        while ( pos < end && ( *pos == '_' || *pos == '$' ||
+                (*pos >= 'a' && *pos <= 'z') || (*pos >= 'A' && *pos <= 'Z') ||
+                (*pos >= '0' && *pos <= '9') ) )
+            pos++;
+        return QByteArray(start,pos-start);
+    }
+};
+
+QVariant json_parse(const QByteArray &data, bool *ok)
+{
+    Json_Parser parser(data);
+    QVariant value = parser.parse();
+    if ( ok )
+        *ok = !parser.failed();
+    return parser.failed() ? QVariant() : value;
+}
+
 QVariant json_read_file(QIODevice& file)
 {
     if ( ! file.isOpen() )
         return QVariant();
 
+    QByteArray json_data = file.readAll();
+    bool ok = false;
+    QVariant value = json_parse(json_data,&ok);
+    if ( ok )
+        return value;
+
+    // Not plain data, let the script engine try
     QScriptEngine engine;
-    QScriptValue obj = json_read_file(file,&engine);
-    return obj.toVariant();
+    return engine.evaluate("(" + QString::fromUtf8(json_data) + ")").toVariant();
 }
 
 QScriptValue json_read_file(QIODevice& file, QScriptEngine* engine)
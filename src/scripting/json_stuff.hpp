@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QVariantMap>
 #include <QTextStream>
 #include <QScriptEngine>
+#include "c++.hpp"
 
 /**
  * \brief Escape a string in order to write it in a JSON file
@@ -56,8 +57,22 @@ void json_convert(QTextStream& json, QVariant v, int indent);
  */
 QScriptValue json_read_file(QIODevice& file, QScriptEngine* engine);
 
+/**
+ * \brief Parse JSON data without a script engine
+ *
+ * Comments, single quoted strings, unquoted keys and trailing commas
+ * are accepted as well
+ * \param data     UTF-8 encoded JSON
+ * \param[out] ok  Whether \p data has been parsed successfully
+ * \return The parsed value, objects are converted to QVariantMap
+ */
+QVariant json_parse(const QByteArray& data, bool* ok = nullptr);
+
 /**
  * \brief Read a JSON file into a QVariantMap
+ *
+ * Uses json_parse(), falling back to a script engine for files which
+ * contain expressions
  * \pre \c file must be open for reading
  * \param file  The JSON file
  * \return The contents of the file as a QVariantMap
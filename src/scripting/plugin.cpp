@@ -38,46 +38,50 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 Plugin::Plugin()
-    : m_type(Invalid), m_enabled(false)
+    : m_type(Invalid), m_enabled(false), m_widgets_loaded(false)
 {
 }
 
 Plugin::Plugin(const QVariantMap &metadata, Plugin::Type type)
-    : m_metadata(metadata), m_type(type), m_enabled(true)
+    : m_metadata(metadata), m_type(type), m_enabled(true),
+      m_widgets_loaded(false)
 {
+    m_enabled = data("auto_enable",true);
+}
 
-    if ( m_metadata.contains("ui") )
-    {
+void Plugin::load_widgets()
+{
+    if ( m_widgets_loaded )
+        return;
+    m_widgets_loaded = true;
 
-       QStringList ui = m_metadata["ui"].toStringList();
-       if ( ui.isEmpty() )
-           ui << m_metadata["ui"].toString();
+    if ( !m_metadata.contains("ui") )
+        return;
 
+    QStringList ui = m_metadata["ui"].toStringList();
+    if ( ui.isEmpty() )
+        ui << m_metadata["ui"].toString();
 
-       foreach(QString file_name, ui)
-       {
-            QFile ui_file(QDir(string_data("plugin_dir"))
-                          .absoluteFilePath(file_name) );
-            if ( ui_file.open(QFile::ReadOnly|QFile::Text) )
+    QUiLoader loader;
+    foreach(QString file_name, ui)
+    {
+        QFile ui_file(QDir(string_data("plugin_dir"))
+                      .absoluteFilePath(file_name) );
+        if ( ui_file.open(QFile::ReadOnly|QFile::Text) )
+        {
+            QWidget *widget = loader.load(&ui_file);
+            if ( widget )
             {
-                QUiLoader loader;
-
-                QWidget *widget = loader.load(&ui_file);
-                if ( widget )
-                {
-                    if ( widget->windowIcon().isNull() )
-                        widget->setWindowIcon(icon());
-                    //((QObject*)widget)->setParent(this);
-                    widget->hide();
-                    m_widgets << widget;
-                    connect(widget,SIGNAL(destroyed(QObject*)),SLOT(dialog_destroyed(QObject*)));
-                }
+                if ( widget->windowIcon().isNull() )
+                    widget->setWindowIcon(icon());
+                if ( m_widget_parent )
+                    widget->setParent(m_widget_parent,Qt::Dialog);
+                widget->hide();
+                m_widgets << widget;
+                connect(widget,SIGNAL(destroyed(QObject*)),SLOT(dialog_destroyed(QObject*)));
             }
-       }
+        }
     }
-
-
-    m_enabled = data("auto_enable",true);
 }
 
 Plugin::~Plugin()
@@ -104,11 +108,14 @@ void Plugin::enable(bool e)
 
 Plugin* Plugin::from_file (QFile &file, QString* error )
 {
-    error->clear();
+    return from_data(json_read_file(file).toMap(),file.fileName(),error);
+}
 
-    QVariantMap data = json_read_file(file).toMap();
+Plugin* Plugin::from_data (QVariantMap data, QString file_name, QString* error )
+{
+    error->clear();
 
-    QFileInfo fi(file.fileName());
+    QFileInfo fi(file_name);
     data["plugin_file"] = fi.absoluteFilePath();
     data["plugin_dir"] = fi.absolutePath();
     data["plugin_shortname"] = fi.baseName();
@@ -167,6 +174,17 @@ Plugin* Plugin::from_file (QFile &file, QString* error )
 
     }
 
+    if ( p->metadata().contains("error") )
+    {
+        *error = p->string_data("error");
+        delete p;
+        return new_error_plugin(data,*error);
+    }
+
+    // Declarative cusps and crossings don't need a script
+    if ( !data.contains("script") && data.contains("geometry") && type != Script )
+        return p;
+
     if ( !data.contains("script") )
     {
         *error = QObject::tr("Missing script file");
@@ -267,12 +285,15 @@ QIcon Plugin::icon() const
 
 void Plugin::execute(Main_Window *window)
 {
+    load_widgets();
     foreach(QWidget* w, m_widgets)
         resource_manager().script.param(w->objectName(),w);
 
     if ( window )
     {
+        // Changes are rendered once, when win destroys its documents
         Script_Window win(window);
+        win.set_deferred_render(true);
         resource_manager().script.param("window",&win);
         resource_manager().script.param("document",win.document());
         resource_manager().script.execute(this);
@@ -284,6 +305,7 @@ void Plugin::execute(Main_Window *window)
 
 void Plugin::set_widget_parent(QWidget *parent)
 {
+    m_widget_parent = parent;
     foreach(QWidget* w, m_widgets)
         w->setParent(parent,Qt::Dialog);
 }
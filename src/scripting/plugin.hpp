@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QScriptProgram>
 #include <QObject>
 #include <QDir>
+#include <QPointer>
 
 class Main_Window;
 
@@ -58,6 +59,8 @@ private:
     bool            m_enabled;
     QScriptProgram  m_script;
     QList<QWidget*> m_widgets;
+    bool            m_widgets_loaded;   ///< Ui files are loaded the first time they are needed
+    QPointer<QWidget> m_widget_parent;
 
 public:
     Plugin();
@@ -98,6 +101,17 @@ public:
      */
     static Plugin* from_file (QFile &file, QString* error );
 
+    /**
+     * \brief Create a plugin from the already parsed contents of a JSON file
+     *
+     * \param[in]  data      Parsed JSON file
+     * \param[in]  file_name Name of the JSON file
+     * \param[out] error     Error string
+     *
+     * \return A Dynamic object of the proper specialized class, NULL if invalid.
+     */
+    static Plugin* from_data (QVariantMap data, QString file_name, QString* error );
+
     QIcon icon() const;
 
     const QScriptProgram& script_program() const { return m_script; }
@@ -170,6 +184,10 @@ signals:
 private slots:
     void dialog_destroyed(QObject*widget);
 
+private:
+    /// Load the ui files, only the first time it's called
+    void load_widgets();
+
 };
 
 Q_DECLARE_METATYPE(Plugin*)
@@ -35,13 +35,16 @@ Plugin_Crossing::Plugin_Crossing(const QVariantMap &metadata)
         set_data("icon","edge-other");
     edge_type = new Edge_Scripted(this);
 
-    if ( is_enabled() )
+    QString error;
+    if ( metadata.contains("geometry") && !edge_type->load_geometry(&error) )
+        set_data("error",error);
+    else if ( is_enabled() )
         enable(true);
 }
 
 Plugin_Crossing::~Plugin_Crossing()
 {
-    if ( !resource_manager().edge_types().contains(edge_type) )
+    if ( !resource_manager().has_edge_type(edge_type) )
         delete edge_type;
 }
 
@@ -50,7 +53,7 @@ void Plugin_Crossing::on_enable(bool b)
 {
     if ( b )
     {
-        if ( !resource_manager().edge_types().contains(edge_type) )
+        if ( !resource_manager().has_edge_type(edge_type) )
             resource_manager().register_edge_type(edge_type);
     }
     else
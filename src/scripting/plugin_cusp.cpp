@@ -35,13 +35,16 @@ Plugin_Cusp::Plugin_Cusp(const QVariantMap &metadata)
         set_data("icon","cusp-other");
     cusp_shape = new Cusp_Scripted(this);
 
-    if ( is_enabled() )
+    QString error;
+    if ( metadata.contains("geometry") && !cusp_shape->load_geometry(&error) )
+        set_data("error",error);
+    else if ( is_enabled() )
         enable(true);
 }
 
 Plugin_Cusp::~Plugin_Cusp()
 {
-    if ( !resource_manager().cusp_shapes().contains(cusp_shape) )
+    if ( !resource_manager().has_cusp_shape(cusp_shape) )
         delete cusp_shape;
 }
 
@@ -50,7 +53,7 @@ void Plugin_Cusp::on_enable(bool b)
 {
     if ( b )
     {
-        if ( !resource_manager().cusp_shapes().contains(cusp_shape) )
+        if ( !resource_manager().has_cusp_shape(cusp_shape) )
             resource_manager().register_cusp_shape(cusp_shape);
     }
     else
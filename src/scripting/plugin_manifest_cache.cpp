@@ -0,0 +1,142 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "plugin_manifest_cache.hpp"
+#include "json_stuff.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+
+Plugin_Manifest_Cache::Plugin_Manifest_Cache(QString file_name)
+    : m_file_name(file_name), loaded(false), dirty(false)
+{
+}
+
+QVariantMap Plugin_Manifest_Cache::manifest(QString file_name, bool *ok)
+{
+    if ( !loaded )
+        load();
+
+    QFileInfo info(file_name);
+    QString key = info.absoluteFilePath();
+
+    QHash<QString,Entry>::iterator it = entries.find(key);
+    if ( it != entries.end() && it->modified == info.lastModified() &&
+            it->size == info.size() )
+    {
+        it->used = true;
+        *ok = true;
+        return it->manifest;
+    }
+
+    QFile file(key);
+    if ( !file.open(QFile::Text|QFile::ReadOnly) )
+    {
+        *ok = false;
+        return QVariantMap();
+    }
+
+    Entry entry;
+    entry.modified = info.lastModified();
+    entry.size = info.size();
+    entry.manifest = json_read_file(file).toMap();
+    entry.used = true;
+    entries[key] = entry;
+    dirty = true;
+
+    *ok = true;
+    return entry.manifest;
+}
+
+void Plugin_Manifest_Cache::load()
+{
+    loaded = true;
+    entries.clear();
+
+    if ( m_file_name.isEmpty() )
+        return;
+
+    QFile file(m_file_name);
+    if ( !file.open(QFile::ReadOnly) )
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    quint32 version = 0;
+    stream >> version;
+    if ( version != format_version )
+        return;
+
+    qint32 count = 0;
+    stream >> count;
+    for ( qint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++ )
+    {
+        QString key;
+        Entry entry;
+        stream >> key >> entry.modified >> entry.size >> entry.manifest;
+        entry.used = false;
+        if ( stream.status() == QDataStream::Ok )
+            entries[key] = entry;
+    }
+}
+
+void Plugin_Manifest_Cache::save()
+{
+    if ( !loaded || m_file_name.isEmpty() )
+        return;
+
+    // drop plugins which are no longer installed
+    for ( QHash<QString,Entry>::iterator it = entries.begin(); it != entries.end(); )
+    {
+        if ( it->used )
+        {
+            it->used = false;
+            ++it;
+        }
+        else
+        {
+            it = entries.erase(it);
+            dirty = true;
+        }
+    }
+
+    if ( !dirty )
+        return;
+
+    QDir().mkpath(QFileInfo(m_file_name).absolutePath());
+    QFile file(m_file_name);
+    if ( !file.open(QFile::WriteOnly|QFile::Truncate) )
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << format_version << qint32(entries.size());
+    for ( QHash<QString,Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it )
+        stream << it.key() << it->modified << it->size << it->manifest;
+
+    dirty = false;
+}
@@ -0,0 +1,78 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PLUGIN_MANIFEST_CACHE_HPP
+#define PLUGIN_MANIFEST_CACHE_HPP
+
+#include <QHash>
+#include <QDateTime>
+#include <QVariantMap>
+
+/**
+ * \brief On-disk cache of parsed plugin_*.json files
+ *
+ * Entries are keyed by path and validated against the modification time and
+ * size of the file, so unchanged plugins are not parsed again at startup.
+ */
+class Plugin_Manifest_Cache
+{
+    struct Entry
+    {
+        QDateTime   modified;
+        qint64      size;
+        QVariantMap manifest;
+        bool        used;   ///< Requested since load(), unused entries are not saved
+    };
+
+    QString                 m_file_name;
+    QHash<QString,Entry>    entries;
+    bool                    loaded;
+    bool                    dirty;
+
+    /// Increase when the cached manifests change meaning
+    static const quint32 format_version = 1;
+
+public:
+    explicit Plugin_Manifest_Cache(QString file_name = QString());
+
+    /**
+     * \brief Get the manifest stored in \p file_name
+     *
+     * The file is parsed only if it isn't cached or it has changed
+     * \param[out] ok Whether the file could be read
+     */
+    QVariantMap manifest(QString file_name, bool* ok);
+
+    /**
+     * \brief Write the cache if anything has changed
+     */
+    void save();
+
+private:
+    void load();
+};
+
+#endif // PLUGIN_MANIFEST_CACHE_HPP
@@ -0,0 +1,222 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "script_profiler.hpp"
+#include <QScriptContextInfo>
+#include <QScriptEngine>
+#include <QStringList>
+#include "plugin.hpp"
+
+Script_Profiler::Script_Profiler(QScriptEngine *engine)
+    : QScriptEngineAgent(engine), m_enabled(false), last_time(0), m_renders(0)
+{
+    timer.start();
+}
+
+void Script_Profiler::set_enabled(bool enabled)
+{
+    m_enabled = enabled;
+    stack.clear();
+    last_line.clear();
+}
+
+void Script_Profiler::clear()
+{
+    functions.clear();
+    lines.clear();
+    callbacks.clear();
+    stack.clear();
+    last_line.clear();
+    m_renders.fetchAndStoreRelaxed(0);
+}
+
+qint64 Script_Profiler::now() const
+{
+#if HAS_QT_4_8
+    return timer.nsecsElapsed();
+#else
+    return timer.elapsed()*1000000;
+#endif
+}
+
+void Script_Profiler::flush_line(qint64 time)
+{
+    if ( !last_line.isEmpty() )
+    {
+        lines[last_line].self += time - last_time;
+        last_line.clear();
+    }
+}
+
+void Script_Profiler::record_callback(const Plugin *plugin, const char *callback)
+{
+    QString name = plugin->string_data("name");
+    Callback_Stats& stats = callbacks[name+':'+callback];
+    if ( stats.calls == 0 )
+    {
+        stats.plugin = name;
+        stats.callback = callback;
+    }
+    stats.calls++;
+}
+
+void Script_Profiler::scriptLoad(qint64 id, const QString &, const QString &fileName, int)
+{
+    script_files[id] = fileName;
+}
+
+void Script_Profiler::scriptUnload(qint64 id)
+{
+    script_files.remove(id);
+}
+
+void Script_Profiler::functionEntry(qint64 scriptId)
+{
+    if ( !m_enabled )
+        return;
+
+    qint64 time = now();
+    flush_line(time);
+
+    QScriptContextInfo info(engine()->currentContext());
+    QString file = scriptId == -1 ? QString("[native]") : script_files.value(scriptId);
+    QString name = info.functionName();
+    if ( name.isEmpty() )
+        name = scriptId == -1 ? QString("[anonymous]") : QString("[program]");
+    int line = qMax(info.functionStartLineNumber(),0);
+
+    Frame frame;
+    frame.key = QString("%1:%2:%3").arg(file).arg(line).arg(name);
+    frame.start = time;
+    frame.children = 0;
+
+    Function_Stats& stats = functions[frame.key];
+    if ( stats.calls == 0 )
+    {
+        stats.file = file;
+        stats.function = name;
+        stats.line = line;
+    }
+    stats.calls++;
+
+    stack.push_back(frame);
+}
+
+void Script_Profiler::functionExit(qint64, const QScriptValue &)
+{
+    if ( !m_enabled || stack.isEmpty() )
+        return;
+
+    qint64 time = now();
+    flush_line(time);
+
+    Frame frame = stack.back();
+    stack.pop_back();
+
+    qint64 total = time - frame.start;
+    Function_Stats& stats = functions[frame.key];
+    stats.total += total;
+    stats.self += total - frame.children;
+
+    if ( !stack.isEmpty() )
+        stack.back().children += total;
+}
+
+void Script_Profiler::positionChange(qint64 scriptId, int lineNumber, int)
+{
+    if ( !m_enabled )
+        return;
+
+    qint64 time = now();
+    flush_line(time);
+
+    QString file = script_files.value(scriptId);
+    last_line = file+':'+QString::number(lineNumber);
+    last_time = time;
+
+    Line_Stats& stats = lines[last_line];
+    if ( stats.hits == 0 )
+    {
+        stats.file = file;
+        stats.line = lineNumber;
+    }
+    stats.hits++;
+}
+
+/// Sort report entries by self time, slowest first
+static bool compare_self_time(const QVariant& a, const QVariant& b)
+{
+    return a.toMap()["self_ms"].toDouble() > b.toMap()["self_ms"].toDouble();
+}
+
+QVariantMap Script_Profiler::report() const
+{
+    QVariantList function_list;
+    foreach ( const Function_Stats& stats, functions )
+    {
+        QVariantMap item;
+        item["file"] = stats.file;
+        item["function"] = stats.function;
+        item["line"] = stats.line;
+        item["calls"] = stats.calls;
+        item["total_ms"] = stats.total / 1e6;
+        item["self_ms"] = stats.self / 1e6;
+        function_list << item;
+    }
+    qSort(function_list.begin(),function_list.end(),compare_self_time);
+
+    QVariantList line_list;
+    foreach ( const Line_Stats& stats, lines )
+    {
+        QVariantMap item;
+        item["file"] = stats.file;
+        item["line"] = stats.line;
+        item["hits"] = stats.hits;
+        item["self_ms"] = stats.self / 1e6;
+        line_list << item;
+    }
+    qSort(line_list.begin(),line_list.end(),compare_self_time);
+
+    int renders = m_renders.fetchAndAddRelaxed(0);
+    QVariantList callback_list;
+    foreach ( const Callback_Stats& stats, callbacks )
+    {
+        QVariantMap item;
+        item["plugin"] = stats.plugin;
+        item["callback"] = stats.callback;
+        item["calls"] = stats.calls;
+        if ( renders > 0 )
+            item["calls_per_render"] = double(stats.calls) / renders;
+        callback_list << item;
+    }
+
+    QVariantMap report;
+    report["renders"] = renders;
+    report["functions"] = function_list;
+    report["lines"] = line_list;
+    report["callbacks"] = callback_list;
+    return report;
+}
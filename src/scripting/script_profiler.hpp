@@ -0,0 +1,151 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SCRIPT_PROFILER_HPP
+#define SCRIPT_PROFILER_HPP
+
+#include <QScriptEngineAgent>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <QHash>
+#include <QVector>
+#include <QAtomicInt>
+#include "c++.hpp"
+
+class Plugin;
+
+/**
+ * \brief Engine agent that collects timing information on script execution
+ *
+ * Time is aggregated per function (total and self) and per line, calls to
+ * scripted cusps and crossings are counted for each render.
+ *
+ * \note Collecting data slows down execution, Resource_Script installs
+ *       the profiler only when it has been enabled.
+ */
+class Script_Profiler : public QScriptEngineAgent
+{
+    struct Function_Stats
+    {
+        QString file;
+        QString function;
+        int     line;
+        qint64  calls;
+        qint64  total;  ///< Nanoseconds, including called functions
+        qint64  self;   ///< Nanoseconds, excluding called functions
+
+        Function_Stats() : line(0), calls(0), total(0), self(0) {}
+    };
+
+    struct Line_Stats
+    {
+        QString file;
+        int     line;
+        qint64  hits;
+        qint64  self;   ///< Nanoseconds
+
+        Line_Stats() : line(0), hits(0), self(0) {}
+    };
+
+    struct Callback_Stats
+    {
+        QString plugin;
+        QString callback;
+        qint64  calls;
+
+        Callback_Stats() : calls(0) {}
+    };
+
+    struct Frame
+    {
+        QString key;
+        qint64  start;
+        qint64  children;
+    };
+
+    bool                            m_enabled;
+    QElapsedTimer                   timer;
+    QHash<qint64,QString>           script_files;
+    QHash<QString,Function_Stats>   functions;
+    QHash<QString,Line_Stats>       lines;
+    QHash<QString,Callback_Stats>   callbacks;
+    QVector<Frame>                  stack;
+    QString                         last_line;  ///< Key of the line being executed
+    qint64                          last_time;
+    mutable QAtomicInt              m_renders;  ///< Graphs render on worker threads too
+
+public:
+    explicit Script_Profiler(QScriptEngine* engine);
+
+    bool is_enabled() const { return m_enabled; }
+
+    /**
+     * \brief Start or stop collecting data
+     * \note Doesn't install the agent on the engine
+     */
+    void set_enabled(bool enabled);
+
+    /// Discard collected data, loaded scripts are still tracked
+    void clear();
+
+    /**
+     * \brief Count a call from a scripted cusp or crossing
+     */
+    void count_callback(const Plugin* plugin, const char* callback)
+    {
+        if ( m_enabled )
+            record_callback(plugin,callback);
+    }
+
+    /// Count a knot render, used to compute callback calls per render
+    void mark_render()
+    {
+        if ( m_enabled )
+            m_renders.fetchAndAddRelaxed(1);
+    }
+
+    /**
+     * \brief Collected data
+     *
+     * Times are in milliseconds, functions and lines are sorted by self time
+     */
+    QVariantMap report() const;
+
+    void scriptLoad(qint64 id, const QString &program,
+                    const QString &fileName, int baseLineNumber) override;
+    void scriptUnload(qint64 id) override;
+    void functionEntry(qint64 scriptId) override;
+    void functionExit(qint64 scriptId, const QScriptValue &returnValue) override;
+    void positionChange(qint64 scriptId, int lineNumber, int columnNumber) override;
+
+private:
+    qint64 now() const;
+    /// Assign the time since the last position change to the last line
+    void flush_line(qint64 time);
+    void record_callback(const Plugin* plugin, const char* callback);
+};
+
+#endif // SCRIPT_PROFILER_HPP
@@ -0,0 +1,370 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "script_worker.hpp"
+#include "resource_manager.hpp"
+#include "knot_view.hpp"
+#include "commands.hpp"
+#include <QScriptEngine>
+#include <QTimer>
+#include <QSet>
+#include <QDebug>
+
+Script_Worker_Document::Script_Worker_Document(Script_Graph *graph, QString filename,
+                                               QScriptEngine *engine)
+    : m_graph(graph), m_filename(filename), engine(engine)
+{
+    connect(m_graph,SIGNAL(edge_added(Script_Edge*)),SLOT(add_edge(Script_Edge*)));
+    connect(m_graph,SIGNAL(node_added(Script_Node*)),SLOT(add_node(Script_Node*)));
+    connect(m_graph,SIGNAL(edges_added(QList<Script_Edge*>)),SLOT(add_edges(QList<Script_Edge*>)));
+    connect(m_graph,SIGNAL(nodes_added(QList<Script_Node*>)),SLOT(add_nodes(QList<Script_Node*>)));
+    connect(m_graph,SIGNAL(node_moved(Script_Node*,Script_Point)),
+            SLOT(move_node(Script_Node*,Script_Point)));
+    connect(m_graph,SIGNAL(edge_removed(Script_Edge*)),SLOT(remove_edge(Script_Edge*)));
+    connect(m_graph,SIGNAL(node_style_changed(Node*,Node_Style,Node_Style)),
+            SLOT(change_node_style(Node*,Node_Style,Node_Style)));
+    connect(m_graph,SIGNAL(edge_style_changed(Edge*,Edge_Style,Edge_Style)),
+            SLOT(change_edge_style(Edge*,Edge_Style,Edge_Style)));
+}
+
+QString Script_Worker_Document::toString() const
+{
+    QString file = m_filename;
+    if ( !file.isEmpty() )
+        file = ' '+file;
+    return QString("[Knot%1]").arg(file);
+}
+
+void Script_Worker_Document::abort_script()
+{
+    if ( engine->isEvaluating() )
+        engine->abortEvaluation(engine->currentContext()->throwError(tr("Script aborted")));
+}
+
+void Script_Worker_Document::add_node(Script_Node *n)
+{
+    m_created_nodes << n->wrapped_node();
+}
+
+void Script_Worker_Document::add_nodes(const QList<Script_Node *> &nodes)
+{
+    foreach ( Script_Node* n, nodes )
+        m_created_nodes << n->wrapped_node();
+}
+
+void Script_Worker_Document::add_edge(Script_Edge *e)
+{
+    m_created_edges << e->wrapped_edge();
+}
+
+void Script_Worker_Document::add_edges(const QList<Script_Edge *> &edges)
+{
+    foreach ( Script_Edge* e, edges )
+        m_created_edges << e->wrapped_edge();
+}
+
+void Script_Worker_Document::remove_edge(Script_Edge *e)
+{
+    e->wrapped_edge()->detach();
+}
+
+void Script_Worker_Document::move_node(Script_Node *n, Script_Point p)
+{
+    n->wrapped_node()->setPos(p);
+}
+
+void Script_Worker_Document::change_node_style(Node *node, Node_Style, Node_Style after)
+{
+    node->set_style(after);
+}
+
+void Script_Worker_Document::change_edge_style(Edge *edge, Edge_Style, Edge_Style after)
+{
+    edge->set_style(after);
+}
+
+
+Script_Worker::Script_Worker(Knot_View *view, QString program, QString file_name,
+                             QVariantMap parameters, QString message)
+    : view(view), program(program), file_name(file_name), parameters(parameters),
+      message(message), document_name(view->file_name()), succeeded(false),
+      aborted(false)
+{
+    const Graph& graph = view->graph();
+
+    QHash<Node*,int> node_index;
+    foreach ( Node* n, graph.nodes() )
+    {
+        node_index[n] = input.nodes.size();
+        input.nodes.push_back(Node_Data(n,n->pos(),n->style(),n->isSelected()));
+    }
+    foreach ( Edge* e, graph.edges() )
+    {
+        input.edges.push_back(Edge_Data(e,node_index.value(e->vertex1(),-1),
+                                        node_index.value(e->vertex2(),-1),e->style()));
+    }
+    input.node_style = graph.default_node_style();
+    input.edge_style = graph.default_edge_style();
+    input.colors = graph.colors();
+
+    // queued: run() ends in the worker thread, the view must be changed in this one
+    connect(this,SIGNAL(finished()),SLOT(apply()),Qt::QueuedConnection);
+}
+
+void Script_Worker::run()
+{
+    QScriptEngine engine;
+    engine.setProcessEventsInterval(500);
+    Resource_Script::register_types(&engine);
+    Resource_Script::set_globals(&engine,false);
+
+    // Build the detached copy, everything created here belongs to this thread
+    Graph detached;
+    detached.set_default_node_style(input.node_style);
+    detached.set_default_edge_style(input.edge_style);
+    detached.set_colors(input.colors);
+
+    QVector<Node*> copy_nodes;
+    QHash<Node*,Node*> node_origin;
+    foreach ( const Node_Data& data, input.nodes )
+    {
+        Node* n = new Node(data.pos);
+        n->set_style(data.style);
+        n->setSelected(data.selected);
+        detached.add_node(n);
+        copy_nodes.push_back(n);
+        node_origin[n] = data.origin;
+    }
+
+    QVector<Edge*> copy_edges;
+    QHash<Edge*,Edge*> edge_origin;
+    foreach ( const Edge_Data& data, input.edges )
+    {
+        if ( data.vertex1 < 0 || data.vertex2 < 0 )
+            continue;
+        Edge* e = new Edge(copy_nodes[data.vertex1],copy_nodes[data.vertex2],
+                           data.style.edge_type);
+        e->set_style(data.style);
+        detached.add_edge(e);
+        copy_edges.push_back(e);
+        edge_origin[e] = data.origin;
+    }
+
+    QList<Node*> created_nodes;
+    QList<Edge*> created_edges;
+    {
+        Script_Graph graph(detached);
+        Script_Worker_Document document(&graph,document_name,&engine);
+
+        QTimer timeout;
+        if ( resource_manager().settings.script_timeout() > 0 )
+        {
+            // fired by the events processed during the evaluation
+            timeout.setSingleShot(true);
+            connect(&timeout,SIGNAL(timeout()),&document,SLOT(abort_script()));
+            timeout.start(1000*resource_manager().settings.script_timeout());
+        }
+
+        // queued: document lives in this thread, abort() is called from the GUI
+        connect(this,SIGNAL(abort_requested()),&document,SLOT(abort_script()));
+
+        engine.globalObject().setProperty("document",engine.newQObject(&document));
+        engine.globalObject().setProperty("params",engine.toScriptValue(parameters));
+
+        // checked after connecting so an earlier abort() isn't missed
+        if ( !aborted )
+            engine.evaluate(program,file_name);
+        timeout.stop();
+
+        if ( engine.hasUncaughtException() )
+        {
+            qWarning() << QObject::tr("%1:%2:Error: %3")
+                          .arg(file_name)
+                          .arg(engine.uncaughtExceptionLineNumber())
+                          .arg(engine.uncaughtException().toString());
+            resource_manager().script.emit_error(file_name,
+                                      engine.uncaughtExceptionLineNumber(),
+                                      engine.uncaughtException().toString(),
+                                      engine.uncaughtExceptionBacktrace()
+                                    );
+        }
+        else if ( !aborted )
+        {
+            QHash<Node*,int> node_index;
+            foreach ( Script_Node* sn, graph.nodes() )
+            {
+                Node* n = sn->wrapped_node();
+                node_index[n] = output.nodes.size();
+                output.nodes.push_back(Node_Data(node_origin.value(n,nullptr),
+                                            n->pos(),n->style(),n->isSelected()));
+            }
+            foreach ( Script_Edge* se, graph.edges() )
+            {
+                Edge* e = se->wrapped_edge();
+                int v1 = node_index.value(e->vertex1(),-1);
+                int v2 = node_index.value(e->vertex2(),-1);
+                if ( v1 < 0 || v2 < 0 )
+                    continue;
+                output.edges.push_back(Edge_Data(edge_origin.value(e,nullptr),
+                                                 v1,v2,e->style()));
+            }
+
+            Script_Graph_Style* style = graph.style();
+            output.node_style = qobject_cast<Script_Node_Style*>(style->cusp_style())->style();
+            output.edge_style = qobject_cast<Script_Edge_Style*>(style->crossing_style())->style();
+            output.colors = style->internal_colors();
+            succeeded = true;
+        }
+
+        created_nodes = document.created_nodes();
+        created_edges = document.created_edges();
+    }
+
+    QSet<Edge*> edges = created_edges.toSet();
+    foreach ( Edge* e, copy_edges )
+        edges.insert(e);
+    qDeleteAll(edges);
+
+    QSet<Node*> nodes = created_nodes.toSet();
+    foreach ( Node* n, copy_nodes )
+        nodes.insert(n);
+    qDeleteAll(nodes);
+}
+
+void Script_Worker::abort()
+{
+    aborted = true;
+    emit abort_requested();
+}
+
+void Script_Worker::apply()
+{
+    if ( view && succeeded )
+    {
+        /*
+            Items removed from the view while the script was running are ignored,
+            changes are applied only where the script has changed the input
+            so edits made by the user in the meantime are preserved
+        */
+        const Graph& graph = view->graph();
+
+        QHash<Node*,const Node_Data*> input_nodes;
+        foreach ( const Node_Data& data, input.nodes )
+            input_nodes[data.origin] = &data;
+        QHash<Edge*,const Edge_Data*> input_edges;
+        foreach ( const Edge_Data& data, input.edges )
+            input_edges[data.origin] = &data;
+
+        // Rendered once, after the macro has been closed
+        Deferred_Render defer(view);
+        view->begin_macro(message.isEmpty() ? tr("Script") : message);
+
+        QVector<Node*> nodes(output.nodes.size(),nullptr);
+        QSet<Node*> kept_nodes;
+        for ( int i = 0; i < output.nodes.size(); i++ )
+        {
+            const Node_Data& data = output.nodes[i];
+            if ( data.origin )
+            {
+                if ( !graph.contains(data.origin) )
+                    continue;
+                Node* node = data.origin;
+                nodes[i] = node;
+                kept_nodes.insert(node);
+                const Node_Data* before = input_nodes.value(node);
+                if ( !before )
+                    continue;
+                if ( before->pos != data.pos )
+                    view->push_command(new Move_Node(node,node->pos(),data.pos,view));
+                if ( before->style != data.style )
+                    view->push_command(new Node_Style_All(node,node->style(),data.style,view));
+                if ( before->selected != data.selected )
+                    node->setSelected(data.selected);
+            }
+            else
+            {
+                Node* node = new Node(data.pos);
+                node->set_style(data.style);
+                view->push_command(new Create_Node(node,view));
+                nodes[i] = node;
+            }
+        }
+
+        QSet<Edge*> kept_edges;
+        foreach ( const Edge_Data& data, output.edges )
+        {
+            if ( data.origin && graph.contains(data.origin) )
+            {
+                Edge* edge = data.origin;
+                kept_edges.insert(edge);
+                const Edge_Data* before = input_edges.value(edge);
+                if ( before && before->style != data.style )
+                    view->push_command(new Edge_Style_All(edge,edge->style(),data.style,view));
+            }
+        }
+
+        // Edges first so Knot_View::remove_node doesn't find them
+        foreach ( const Edge_Data& data, input.edges )
+            if ( !kept_edges.contains(data.origin) && graph.contains(data.origin) )
+                view->remove_edge(data.origin);
+        foreach ( const Node_Data& data, input.nodes )
+            if ( !kept_nodes.contains(data.origin) && graph.contains(data.origin) )
+                view->remove_node(data.origin);
+
+        foreach ( const Edge_Data& data, output.edges )
+        {
+            if ( data.origin )
+                continue;
+            Node* v1 = nodes[data.vertex1];
+            Node* v2 = nodes[data.vertex2];
+            if ( !v1 || !v2 || v1 == v2 || v1->has_edge_to(v2) )
+                continue;
+            Edge* edge = new Edge(v1,v2,data.style.edge_type);
+            edge->set_style(data.style);
+            view->push_command(new Create_Edge(edge,view));
+        }
+
+        if ( input.node_style != output.node_style ||
+             input.edge_style != output.edge_style )
+        {
+            // Only the default style changed by the script is replaced
+            Node_Style node_style = input.node_style != output.node_style ?
+                        output.node_style : graph.default_node_style();
+            Edge_Style edge_style = input.edge_style != output.edge_style ?
+                        output.edge_style : graph.default_edge_style();
+            view->push_command(new Knot_Style_All(
+                                   graph.default_node_style(),node_style,
+                                   graph.default_edge_style(),edge_style,
+                                   view));
+        }
+        if ( input.colors != output.colors )
+            view->set_knot_colors(output.colors);
+
+        view->end_macro();
+    }
+
+    deleteLater();
+}
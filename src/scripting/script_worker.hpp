@@ -0,0 +1,203 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SCRIPT_WORKER_HPP
+#define SCRIPT_WORKER_HPP
+
+#include <QThread>
+#include <QPointer>
+#include <QVariantMap>
+#include <QVector>
+#include "script_graph.hpp"
+
+class Knot_View;
+class QScriptEngine;
+
+/**
+ * \brief Document object exposed to scripts running on a Script_Worker
+ *
+ * Mirrors the graph part of Script_Document but changes are applied directly
+ * to the detached copy of the graph instead of being pushed to the undo stack.
+ */
+class Script_Worker_Document : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString filename READ filename)
+    Q_PROPERTY(QObject* graph READ graph)
+
+    Script_Graph*   m_graph;
+    QString         m_filename;
+    QScriptEngine*  engine;
+    QList<Node*>    m_created_nodes;
+    QList<Edge*>    m_created_edges;
+
+public:
+    Script_Worker_Document(Script_Graph* graph, QString filename,
+                           QScriptEngine* engine);
+
+    QString filename() const { return m_filename; }
+    QObject* graph() { return m_graph; }
+
+    /// Nodes created by the script, including the ones it has removed
+    QList<Node*> created_nodes() const { return m_created_nodes; }
+    /// Edges created by the script, including the ones it has removed
+    QList<Edge*> created_edges() const { return m_created_edges; }
+
+    /// Does nothing, the whole run is applied as a single action
+    Q_INVOKABLE void begin_macro(QString) {}
+    /// Does nothing, the whole run is applied as a single action
+    Q_INVOKABLE void end_macro() {}
+    /// Does nothing, the whole run is applied as a single action
+    Q_INVOKABLE void begin_transaction(QString) {}
+    /// Does nothing, the whole run is applied as a single action
+    Q_INVOKABLE void end_transaction() {}
+    /// Does nothing, the knot is rendered once the run has been applied
+    Q_INVOKABLE void suspend_render() {}
+    /// Does nothing, the knot is rendered once the run has been applied
+    Q_INVOKABLE void resume_render() {}
+
+    Q_INVOKABLE QString toString() const;
+
+public slots:
+    /// Stop the script running on the worker
+    void abort_script();
+
+private slots:
+    void add_node(Script_Node* n);
+    void add_nodes(const QList<Script_Node*>& nodes);
+    void add_edge(Script_Edge* e);
+    void add_edges(const QList<Script_Edge*>& edges);
+    void remove_edge(Script_Edge* e);
+    void move_node(Script_Node* n, Script_Point p);
+    void change_node_style(Node* node, Node_Style before, Node_Style after );
+    void change_edge_style(Edge* edge, Edge_Style before, Edge_Style after );
+};
+
+/**
+ * \brief Runs a script on its own engine and thread
+ *
+ * The script works on a detached copy of the graph of a Knot_View,
+ * when it's done the differences between the copy and the graph are applied
+ * to the view as a single undo command, causing a single render.
+ *
+ * The copy is taken when the worker is created, nodes and edges are
+ * identified by their original pointer which is never dereferenced outside
+ * the GUI thread.
+ *
+ * Only the graph can be accessed by the script: it can't show dialogs or
+ * create widgets so all the user input must be gathered before starting it
+ * and passed in the parameters.
+ *
+ * The worker deletes itself after the changes have been applied.
+ * Workers are started and tracked by Resource_Script::start_worker() so they
+ * can be stopped when the view is closed or the application quits.
+ */
+class Script_Worker : public QThread
+{
+    Q_OBJECT
+
+    struct Node_Data
+    {
+        Node*       origin; ///< Node in the view, nullptr if created by the script
+        QPointF     pos;
+        Node_Style  style;
+        bool        selected;
+
+        Node_Data(Node* origin=nullptr, QPointF pos=QPointF(),
+                  Node_Style style=Node_Style(), bool selected = false)
+            : origin(origin), pos(pos), style(style), selected(selected) {}
+    };
+
+    struct Edge_Data
+    {
+        Edge*       origin; ///< Edge in the view, nullptr if created by the script
+        int         vertex1;///< Index in the node list
+        int         vertex2;///< Index in the node list
+        Edge_Style  style;
+
+        Edge_Data(Edge* origin=nullptr, int vertex1=-1, int vertex2=-1,
+                  Edge_Style style=Edge_Style())
+            : origin(origin), vertex1(vertex1), vertex2(vertex2), style(style) {}
+    };
+
+    /// Graph contents, detached from the actual nodes and edges
+    struct Graph_Data
+    {
+        QVector<Node_Data>  nodes;
+        QVector<Edge_Data>  edges;
+        Node_Style          node_style;
+        Edge_Style          edge_style;
+        QList<QColor>       colors;
+    };
+
+    QPointer<Knot_View> view;
+    QString             program;
+    QString             file_name;
+    QVariantMap         parameters;
+    QString             message;
+    QString             document_name;
+    Graph_Data          input;
+    Graph_Data          output;
+    bool                succeeded;
+    volatile bool       aborted;
+
+public:
+    /**
+     * \brief Prepare a worker for the given view
+     * \param view       View the changes will be applied to
+     * \param program    Script source
+     * \param file_name  Script file name, used for error reporting
+     * \param parameters Values available to the script as \c params
+     * \param message    Undo command text
+     * \note Must be called from the GUI thread, the graph is copied here
+     */
+    Script_Worker(Knot_View* view, QString program, QString file_name,
+                  QVariantMap parameters, QString message);
+
+    /// View the changes will be applied to
+    const Knot_View* target() const { return view; }
+
+public slots:
+    /**
+     * \brief Stop the script, nothing will be applied to the view
+     * \note Returns immediately, use wait() to wait for the thread to finish
+     */
+    void abort();
+
+signals:
+    /// Forwarded to the document in the worker thread
+    void abort_requested();
+
+protected:
+    void run() override;
+
+private slots:
+    /// Apply the changes to the view and schedule deletion
+    void apply();
+};
+
+#endif // SCRIPT_WORKER_HPP
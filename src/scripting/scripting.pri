@@ -19,6 +19,7 @@ HEADERS += \
     $$PWD/wrappers/script_line.hpp \
     $$PWD/wrappers/script_point.hpp \
     $$PWD/plugin.hpp \
+    $$PWD/plugin_manifest_cache.hpp \
     $$PWD/cusp_scripted.hpp \
     $$PWD/plugin_cusp.hpp \
     $$PWD/wrappers/script_path_builder.hpp \
@@ -38,11 +39,15 @@ HEADERS += \
     $$PWD/plugin_crossing.hpp \
     $$PWD/edge_scripted.hpp \
     $$PWD/json_stuff.hpp \
-    $$PWD/wrappers/script_qtablewidget.hpp
+    $$PWD/wrappers/script_qtablewidget.hpp \
+    $$PWD/geometry_template.hpp \
+    $$PWD/script_profiler.hpp \
+    $$PWD/script_worker.hpp
 
 SOURCES += \
     $$PWD/wrappers/script_line.cpp \
     $$PWD/plugin.cpp \
+    $$PWD/plugin_manifest_cache.cpp \
     $$PWD/wrappers/script_point.cpp \
     $$PWD/cusp_scripted.cpp \
     $$PWD/plugin_cusp.cpp \
@@ -63,4 +68,7 @@ SOURCES += \
     $$PWD/plugin_crossing.cpp \
     $$PWD/edge_scripted.cpp \
     $$PWD/json_stuff.cpp \
-    $$PWD/wrappers/script_qtablewidget.cpp
+    $$PWD/wrappers/script_qtablewidget.cpp \
+    $$PWD/geometry_template.cpp \
+    $$PWD/script_profiler.cpp \
+    $$PWD/script_worker.cpp
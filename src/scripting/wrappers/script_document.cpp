@@ -27,17 +27,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "script_document.hpp"
 #include "commands.hpp"
 #include "xml_exporter.hpp"
+#include "script_worker.hpp"
+#include "resource_manager.hpp"
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QScriptContextInfo>
 
 Script_Document::Script_Document(Knot_View *wrapped, QObject *parent) :
     QObject(parent), wrapped(wrapped), m_graph(wrapped->graph()),
-    m_grid(&wrapped->grid()), macro_count(0), m_render(&wrapped->graph())
+    m_grid(&wrapped->grid()), macro_count(0), render_count(0),
+    m_render(&wrapped->graph(),wrapped)
 {
     connect(&m_graph,SIGNAL(edge_added(Script_Edge*)),SLOT(add_edge(Script_Edge*)));
     connect(&m_graph,SIGNAL(node_added(Script_Node*)),SLOT(add_node(Script_Node*)));
     connect(&m_graph,SIGNAL(node_moved(Script_Node*,Script_Point)),
             SLOT(move_node(Script_Node*,Script_Point)));
     connect(&m_graph,SIGNAL(node_removed(Script_Node*)),SLOT(remove_node(Script_Node*)));
+    connect(&m_graph,SIGNAL(nodes_added(QList<Script_Node*>)),
+            SLOT(add_nodes(QList<Script_Node*>)));
+    connect(&m_graph,SIGNAL(edges_added(QList<Script_Edge*>)),
+            SLOT(add_edges(QList<Script_Edge*>)));
+    connect(&m_graph,SIGNAL(nodes_moved(QList<Script_Node*>,QList<QPointF>)),
+            SLOT(move_nodes(QList<Script_Node*>,QList<QPointF>)));
     connect(&m_graph,SIGNAL(edge_removed(Script_Edge*)),SLOT(remove_edge(Script_Edge*)));
     connect(&m_graph,SIGNAL(node_style_changed(Node*,Node_Style,Node_Style)),
             SLOT(change_node_style(Node*,Node_Style,Node_Style)));
@@ -113,6 +125,35 @@ void Script_Document::move_node(Script_Node *n, Script_Point p)
     wrapped->push_command(new Move_Node(real,real->pos(),p,wrapped));
 }
 
+void Script_Document::add_nodes(const QList<Script_Node *> &nodes)
+{
+    // The macro renders the knot only once all the nodes have been added
+    wrapped->begin_macro(tr("Add Nodes"));
+    foreach ( Script_Node* n, nodes )
+        wrapped->push_command(new Create_Node(n->wrapped_node(),wrapped));
+    wrapped->end_macro();
+}
+
+void Script_Document::add_edges(const QList<Script_Edge *> &edges)
+{
+    wrapped->begin_macro(tr("Add Edges"));
+    foreach ( Script_Edge* e, edges )
+        wrapped->push_command(new Create_Edge(e->wrapped_edge(),wrapped));
+    wrapped->end_macro();
+}
+
+void Script_Document::move_nodes(const QList<Script_Node *> &nodes,
+                                 const QList<QPointF> &positions)
+{
+    wrapped->begin_macro(tr("Move Nodes"));
+    for ( int i = 0; i < nodes.size(); i++ )
+    {
+        Node* real = nodes[i]->wrapped_node();
+        wrapped->push_command(new Move_Node(real,real->pos(),positions[i],wrapped));
+    }
+    wrapped->end_macro();
+}
+
 void Script_Document::change_node_style(Node *node, Node_Style before, Node_Style after)
 {
     wrapped->push_command(new Node_Style_All(node,before,after,wrapped));
@@ -152,6 +193,34 @@ void Script_Document::clean_macros()
 {
     while(macro_count > 0)
         end_macro();
+    while(render_count > 0)
+        resume_render();
+}
+
+void Script_Document::suspend_render()
+{
+    wrapped->suspend_render();
+    render_count++;
+}
+
+void Script_Document::resume_render()
+{
+    if ( render_count <= 0 )
+        return;
+    render_count--;
+    wrapped->resume_render();
+}
+
+void Script_Document::begin_transaction(QString message)
+{
+    begin_macro(message);
+    suspend_render();
+}
+
+void Script_Document::end_transaction()
+{
+    end_macro();
+    resume_render();
 }
 
 bool Script_Document::open(QString file)
@@ -179,3 +248,31 @@ bool Script_Document::save(QString file)
         return export_xml(wrapped->graph(),out);
     return false;
 }
+
+bool Script_Document::run_worker(QString file, QVariantMap parameters, QString message)
+{
+    if ( QFileInfo(file).isRelative() && context() && context()->parentContext() )
+    {
+        QScriptContextInfo caller(context()->parentContext());
+        if ( !caller.fileName().isEmpty() )
+            file = QFileInfo(caller.fileName()).dir().absoluteFilePath(file);
+    }
+
+    QFile source(file);
+    if ( !source.open(QFile::ReadOnly|QFile::Text) )
+    {
+        if ( context() )
+            context()->throwError(tr("Cannot open file \"%1\"").arg(file));
+        return false;
+    }
+
+    Script_Worker* worker = new Script_Worker(wrapped,source.readAll(),file,
+                                              parameters,message);
+    resource_manager().script.start_worker(worker);
+    return true;
+}
+
+void Script_Document::cancel_workers()
+{
+    resource_manager().script.stop_workers(wrapped);
+}
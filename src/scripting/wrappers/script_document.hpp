@@ -28,6 +28,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SCRIPT_DOCUMENT_HPP
 
 #include <QObject>
+#include <QScriptable>
+#include <QVariantMap>
 #include "script_graph.hpp"
 #include "knot_view.hpp"
 #include "script_grid.hpp"
@@ -36,7 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /**
  * @brief Wrapper to Knot_View
  */
-class Script_Document : public QObject
+class Script_Document : public QObject, protected QScriptable
 {
     Q_OBJECT
 
@@ -49,6 +51,7 @@ class Script_Document : public QObject
     Script_Graph    m_graph;
     Script_Grid     m_grid;
     int             macro_count;
+    int             render_count;   ///< Number of unmatched suspend_render()
     Script_Renderer m_render;
 
 public:
@@ -78,8 +81,25 @@ public:
 
     Q_INVOKABLE void begin_macro(QString message);
     Q_INVOKABLE void end_macro();
+    /// Close unmatched macros and render suspensions
     void clean_macros();
 
+    /**
+     * \brief Defer rendering until the matching resume_render()
+     * \see Knot_View::suspend_render()
+     */
+    Q_INVOKABLE void suspend_render();
+    Q_INVOKABLE void resume_render();
+
+    /**
+     * \brief Start a single undoable action which is rendered once at the end
+     *
+     * Same as begin_macro() followed by suspend_render()
+     */
+    Q_INVOKABLE void begin_transaction(QString message);
+    /// Ends the scope opened by begin_transaction()
+    Q_INVOKABLE void end_transaction();
+
     /**
      * \brief Open file
      *
@@ -94,12 +114,41 @@ public:
      */
     Q_INVOKABLE bool save(QString file);
 
+    /**
+     * \brief Run a script file in the background
+     *
+     * The script is executed on a separate engine and thread, it can access
+     * a copy of this document as \c document and the parameters as \c params.
+     * Its changes are applied as a single action once it has finished.
+     *
+     * The script can't interact with the user, dialogs must be shown before
+     * calling this.
+     *
+     * \param file       Script file, relative paths are resolved from the calling script
+     * \param parameters Values passed to the script
+     * \param message    Name of the resulting action
+     * \return true if the script has been started
+     * \see Script_Worker
+     */
+    Q_INVOKABLE bool run_worker(QString file, QVariantMap parameters = QVariantMap(),
+                                QString message = QString());
+
+    /**
+     * \brief Abort the scripts started by run_worker() on this document
+     *
+     * Their changes are discarded
+     */
+    Q_INVOKABLE void cancel_workers();
+
 private slots:
     void add_node(Script_Node* n);
     void remove_node(Script_Node* n);
     void remove_edge(Script_Edge* e);
     void add_edge(Script_Edge* e);
     void move_node(Script_Node* n, Script_Point p);
+    void add_nodes(const QList<Script_Node*>& nodes);
+    void add_edges(const QList<Script_Edge*>& edges);
+    void move_nodes(const QList<Script_Node*>& nodes, const QList<QPointF>& positions);
     void change_node_style(Node* node, Node_Style before, Node_Style after );
     void change_edge_style(Edge* edge, Edge_Style before, Edge_Style after );
     void change_graph_style(Node_Style bef_node, Edge_Style bef_edge,
@@ -29,7 +29,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "resource_manager.hpp"
 
 Script_Edge::Script_Edge(Edge *wrapped, Script_Graph *graph):
-    QObject(graph), wrapped(wrapped), graph(graph), m_style(wrapped->style())
+    QObject(graph), wrapped(wrapped), graph(graph), m_style(wrapped->style()),
+    m_style_revision(graph->style_revision())
 {
     connect(&m_style,SIGNAL(changed(Edge_Style,Edge_Style)),
             SLOT(emit_style_changed(Edge_Style,Edge_Style)));
@@ -70,6 +71,16 @@ QString Script_Edge::toString() const
     return "[edge]";
 }
 
+Script_Edge_Style *Script_Edge::style()
+{
+    if ( m_style_revision != graph->style_revision() )
+    {
+        m_style.reset_style(wrapped->style());
+        m_style_revision = graph->style_revision();
+    }
+    return &m_style;
+}
+
 void Script_Edge::set_style(QObject *object)
 {
     Script_Edge_Style* style = qobject_cast<Script_Edge_Style*>(object);
@@ -50,6 +50,7 @@ class Script_Edge : public QObject
     Edge* wrapped;
     Script_Graph* graph;
     Script_Edge_Style m_style;
+    unsigned          m_style_revision; ///< Script_Graph::style_revision() at last sync
 
 public:
     explicit Script_Edge(Edge* wrapped, Script_Graph* graph );
@@ -67,7 +68,7 @@ public:
 
     Q_INVOKABLE QString toString() const;
 
-    Script_Edge_Style* style() { return &m_style; }
+    Script_Edge_Style* style();
     void set_style(QObject* style);
 
 
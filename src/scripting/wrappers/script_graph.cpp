@@ -27,11 +27,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "script_graph.hpp"
 #include "resource_manager.hpp"
 #include "xml_loader.hpp"
+#include "graph_algorithms.hpp"
 
 Script_Graph::Script_Graph(const Graph &graph, QObject *parent) :
     QObject(parent),
     m_style(graph.default_edge_style(),graph.default_node_style(),
-            graph.colors())
+            graph.colors()),
+    m_style_revision(0)
 {
     from_graph(graph);
     QObject::connect(&m_style,SIGNAL(style_changed(Node_Style,Edge_Style,Node_Style,Edge_Style)),
@@ -41,7 +43,7 @@ Script_Graph::Script_Graph(const Graph &graph, QObject *parent) :
 
 Script_Graph::Script_Graph(const Script_Graph &g)
     : QObject(g.parent()),
-      m_style(g.m_style)
+      m_style(g.m_style), m_style_revision(0)
 {
     QObject::connect(&m_style,SIGNAL(style_changed(Node_Style,Edge_Style,Node_Style,Edge_Style)),
             SIGNAL(style_changed(Node_Style,Edge_Style,Node_Style,Edge_Style)));
@@ -208,23 +210,21 @@ void Script_Graph::emit_node_moved(Script_Point pos)
 
 void Script_Graph::node_removed()
 {
-    Node *n = qobject_cast<Node*>(sender());
-    if ( n )
+    Script_Node* sn = node_map.take(sender());
+    if ( sn )
     {
-        m_nodes.removeAll(node_map[n]);
-        delete node_map[n];
-        node_map.remove(n);
+        m_nodes.removeAll(sn);
+        delete sn;
     }
 }
 
 void Script_Graph::edge_removed()
 {
-    Edge *e = qobject_cast<Edge*>(sender());
-    if ( e )
+    Script_Edge* se = edge_map.take(sender());
+    if ( se )
     {
-        m_edges.removeAll(edge_map[e]);
-        delete edge_map[e];
-        edge_map.remove(e);
+        m_edges.removeAll(se);
+        delete se;
     }
 }
 
@@ -309,11 +309,192 @@ QObjectList Script_Graph::nodes_at(double x, double y, double radius)
 }
 
 
+QList<Node*> Script_Graph::wrapped_nodes(const QObjectList &list) const
+{
+    QList<Node*> nodes;
+    foreach(QObject* o, list)
+    {
+        Script_Node* n = qobject_cast<Script_Node*>(o);
+        if ( n && n->parent() == this )
+            nodes << n->wrapped_node();
+    }
+    return nodes;
+}
+
+QObjectList Script_Graph::script_nodes(const QList<Node *> &list) const
+{
+    QObjectList nodes;
+    foreach(Node* n, list)
+    {
+        Script_Node* sn = node_map.value(n,nullptr);
+        if ( sn )
+            nodes << sn;
+    }
+    return nodes;
+}
+
+QObjectList Script_Graph::connected_nodes(QObjectList start)
+{
+    QSet<Node*> members;
+    foreach(Script_Node* n, m_nodes)
+        members.insert(n->wrapped_node());
+    return script_nodes(::connected_nodes(wrapped_nodes(start),members));
+}
+
+QVariantList Script_Graph::connected_components()
+{
+    QList<Node*> nodes;
+    foreach(Script_Node* n, m_nodes)
+        nodes << n->wrapped_node();
+
+    QVariantList components;
+    foreach(const QList<Node*>& component, ::connected_components(nodes))
+    {
+        QVariantList list;
+        foreach(QObject* n, script_nodes(component))
+            list << QVariant::fromValue(n);
+        components << QVariant(list);
+    }
+    return components;
+}
+
+QObjectList Script_Graph::neighbours(QObjectList group)
+{
+    return script_nodes(neighbourhood(wrapped_nodes(group)));
+}
+
+QObject *Script_Graph::merge(QObjectList group)
+{
+    QList<Node*> nodes = wrapped_nodes(group);
+    if ( nodes.empty() )
+        return nullptr;
+
+    Node_Contraction merged = contract_nodes(nodes);
+    QObjectList outlinks = script_nodes(merged.outlinks);
+
+    foreach(QObject* n, script_nodes(nodes))
+        remove_node(n);
+
+    QObject* node = add_node(Script_Point(merged.pos));
+    foreach(QObject* n, outlinks)
+        connect(node,n);
+    return node;
+}
+
+int Script_Graph::add_nodes(QVariantList coordinates)
+{
+    int first = m_nodes.size();
+
+    QList<Script_Node*> added;
+    added.reserve(coordinates.size()/2);
+    for ( int i = 0; i+1 < coordinates.size(); i += 2 )
+    {
+        QPointF p(coordinates[i].toDouble(),coordinates[i+1].toDouble());
+        added << add_node(new Node(p));
+    }
+
+    if ( !added.empty() )
+        emit nodes_added(added);
+    return first;
+}
+
+int Script_Graph::connect_nodes(QVariantList indices)
+{
+    Edge_Type* type = resource_manager().default_edge_type();
+
+    QList<Script_Edge*> added;
+    for ( int i = 0; i+1 < indices.size(); i += 2 )
+    {
+        int i1 = indices[i].toInt();
+        int i2 = indices[i+1].toInt();
+        if ( i1 < 0 || i2 < 0 || i1 >= m_nodes.size() || i2 >= m_nodes.size() )
+            continue;
+
+        Node* n1 = m_nodes[i1]->wrapped_node();
+        Node* n2 = m_nodes[i2]->wrapped_node();
+        // Edge attaches itself to the nodes, so this also catches duplicated pairs
+        if ( n1 == n2 || n1->has_edge_to(n2) )
+            continue;
+
+        added << add_edge(new Edge(n1,n2,type));
+    }
+
+    if ( !added.empty() )
+        emit edges_added(added);
+    return added.size();
+}
+
+QVariantList Script_Graph::node_positions() const
+{
+    QVariantList coordinates;
+    coordinates.reserve(m_nodes.size()*2);
+    foreach ( Script_Node* n, m_nodes )
+    {
+        QPointF p = n->wrapped_node()->pos();
+        coordinates << p.x() << p.y();
+    }
+    return coordinates;
+}
+
+void Script_Graph::set_node_positions(QVariantList coordinates, int first)
+{
+    if ( first < 0 )
+        return;
+
+    QList<Script_Node*> moved;
+    QList<QPointF> positions;
+    for ( int i = 0; i+1 < coordinates.size() && first+i/2 < m_nodes.size(); i += 2 )
+    {
+        Script_Node* n = m_nodes[first+i/2];
+        QPointF p(coordinates[i].toDouble(),coordinates[i+1].toDouble());
+        if ( n->wrapped_node()->pos() != p )
+        {
+            moved << n;
+            positions << p;
+        }
+    }
+
+    if ( moved.empty() )
+        return;
+
+    emit nodes_moved(moved,positions);
+    for ( int i = 0; i < moved.size(); i++ )
+        moved[i]->wrapped_node()->setPos(positions[i]);
+}
+
+QVariantList Script_Graph::edge_indices() const
+{
+    QHash<const Node*,int> node_index;
+    node_index.reserve(m_nodes.size());
+    for ( int i = 0; i < m_nodes.size(); i++ )
+        node_index[m_nodes[i]->wrapped_node()] = i;
+
+    QVariantList indices;
+    indices.reserve(m_edges.size()*2);
+    foreach ( Script_Edge* se, m_edges )
+    {
+        const Edge* e = se->wrapped_edge();
+        int i1 = node_index.value(e->vertex1(),-1);
+        int i2 = node_index.value(e->vertex2(),-1);
+        if ( i1 >= 0 && i2 >= 0 )
+            indices << i1 << i2;
+    }
+    return indices;
+}
+
+QVariantList Script_Graph::selected_node_indices() const
+{
+    QVariantList indices;
+    for ( int i = 0; i < m_nodes.size(); i++ )
+        if ( m_nodes[i]->selected() )
+            indices << i;
+    return indices;
+}
+
 bool Script_Graph::append(QString file, bool keep_style, Script_Point offset)
 {
     Graph graph;
-    QFile knot_file(file);
-    if ( ! import_xml(knot_file,graph) )
+    if ( ! import_xml(file,graph) )
         return false;
 
     foreach(Node* n, graph.nodes())
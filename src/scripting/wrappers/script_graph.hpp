@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SCRIPT_GRAPH_HPP
 
 #include <QObject>
+#include <QVariantList>
 #include "graph.hpp"
 #include "script_edge.hpp"
 #include "script_graph_style.hpp"
@@ -48,14 +49,20 @@ class Script_Graph : public QObject
     friend void graph_from_script(const QScriptValue &obj, Script_Graph &graph);
 
 
-    QMap<Node*,Script_Node*> node_map;
-    QMap<Edge*,Script_Edge*> edge_map;
+    /**
+     * Keyed by QObject so destroyed() can find the wrapper,
+     * the Node/Edge part of sender() is already gone at that point
+     */
+    QMap<QObject*,Script_Node*> node_map;
+    QMap<QObject*,Script_Edge*> edge_map;
 
     QList<Script_Node*> m_nodes;
     QList<Script_Edge*> m_edges;
 
     Script_Graph_Style m_style;
 
+    unsigned m_style_revision; ///< Incremented when wrapped styles may be outdated
+
 
 public:
     explicit Script_Graph(const Graph &graph=Graph(), QObject *parent = 0);
@@ -152,6 +159,74 @@ public:
      */
     Q_INVOKABLE QObjectList nodes_at(double x, double y, double radius);
 
+    /**
+     * \brief Nodes reachable from the given ones, including them
+     */
+    Q_INVOKABLE QObjectList connected_nodes(QObjectList start);
+    /**
+     * \brief Split the graph in connected parts
+     * \return An array of arrays of nodes
+     */
+    Q_INVOKABLE QVariantList connected_components();
+    /**
+     * \brief Nodes outside the group connected to it
+     */
+    Q_INVOKABLE QObjectList neighbours(QObjectList group);
+    /**
+     * \brief Replace a group of nodes with a single one
+     *
+     * The new node is placed at the average position and connected to
+     * all the nodes the group was connected to.
+     *
+     * \return The new node
+     */
+    Q_INVOKABLE QObject* merge(QObjectList group);
+
+    /**
+     * \brief Add many nodes at once
+     *
+     * Emits nodes_added() once, the script document records a single action.
+     *
+     * \param coordinates Flat array of coordinates: x0, y0, x1, y1...
+     * \return Index in nodes of the first new node
+     */
+    Q_INVOKABLE int add_nodes(QVariantList coordinates);
+    /**
+     * \brief Connect many pairs of nodes at once
+     *
+     * Pairs which are out of range, connect a node to itself or are
+     * already connected are skipped.
+     * Emits edges_added() once, the script document records a single action.
+     *
+     * \param indices Flat array of node indices: from0, to0, from1, to1...
+     * \return Number of edges created
+     */
+    Q_INVOKABLE int connect_nodes(QVariantList indices);
+    /**
+     * \brief Positions of all the nodes
+     * \return Flat array of coordinates in the same order as nodes
+     */
+    Q_INVOKABLE QVariantList node_positions() const;
+    /**
+     * \brief Move many nodes at once
+     *
+     * Nodes whose position doesn't change are ignored.
+     * Emits nodes_moved() once, the script document records a single action.
+     *
+     * \param coordinates Flat array of coordinates
+     * \param first       Index of the node corresponding to the first pair of coordinates
+     */
+    Q_INVOKABLE void set_node_positions(QVariantList coordinates, int first = 0);
+    /**
+     * \brief Edges as pairs of node indices
+     * \return Flat array of node indices: from0, to0, from1, to1...
+     */
+    Q_INVOKABLE QVariantList edge_indices() const;
+    /**
+     * \brief Indices of the selected nodes
+     */
+    Q_INVOKABLE QVariantList selected_node_indices() const;
+
     /**
      * \brief List of nodes
      */
@@ -204,12 +279,27 @@ public:
 
     Script_Graph_Style* style() { return &m_style; }
 
+    /**
+     * \brief Mark the styles held by node and edge wrappers as outdated
+     *
+     * Wrappers will reload the style from the wrapped object when accessed
+     */
+    void refresh_styles() { m_style_revision++; }
+
+    unsigned style_revision() const { return m_style_revision; }
+
 signals:
     void node_added(Script_Node* n);
     void node_removed(Script_Node* n);
     void edge_added(Script_Edge* e);
     void edge_removed(Script_Edge* e);
     void node_moved(Script_Node* n, Script_Point pos);
+    /// Emitted by the bulk functions instead of node_added()
+    void nodes_added(const QList<Script_Node*>& nodes);
+    /// Emitted by the bulk functions instead of edge_added()
+    void edges_added(const QList<Script_Edge*>& edges);
+    /// Emitted by the bulk functions before the nodes are moved
+    void nodes_moved(const QList<Script_Node*>& nodes, const QList<QPointF>& positions);
     void edge_style_changed(Edge* edge, Edge_Style before, Edge_Style after);
     void node_style_changed(Node* node, Node_Style before, Node_Style after );
     void style_changed(Node_Style bef_node, Edge_Style bef_edge,
@@ -222,6 +312,11 @@ private slots:
     void edge_removed();
 
 private:
+    /// Wrapped nodes of the Script_Node objects in the list which belong to this graph
+    QList<Node*> wrapped_nodes(const QObjectList& list) const;
+    /// Convert wrapped nodes back to their Script_Node objects
+    QObjectList script_nodes(const QList<Node*>& list) const;
+
     /**
      * \brief List of nodes, as seen from the script
      */
@@ -30,7 +30,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 Script_Node::Script_Node(Node *n, Script_Graph *graph):
     QObject(graph),
-    m_wrapped_node(n), graph(graph), m_style(m_wrapped_node->style())
+    m_wrapped_node(n), graph(graph), m_style(m_wrapped_node->style()),
+    m_style_revision(graph->style_revision())
 {
     connect(&m_style,SIGNAL(changed(Node_Style,Node_Style)),
             SLOT(emit_style_changed(Node_Style,Node_Style)));
@@ -38,7 +39,8 @@ Script_Node::Script_Node(Node *n, Script_Graph *graph):
 
 Script_Node::Script_Node(const Script_Node &o)
     : QObject(o.parent()),
-      m_wrapped_node(o.m_wrapped_node), graph(o.graph), m_style(m_wrapped_node->style())
+      m_wrapped_node(o.m_wrapped_node), graph(o.graph), m_style(m_wrapped_node->style()),
+      m_style_revision(o.m_style_revision)
 {
     connect(&m_style,SIGNAL(changed(Node_Style,Node_Style)),
             SLOT(emit_style_changed(Node_Style,Node_Style)));
@@ -112,6 +114,16 @@ bool Script_Node::compare(Script_Node *n) const
     return n->m_wrapped_node == m_wrapped_node;
 }
 
+Script_Node_Style *Script_Node::style()
+{
+    if ( m_style_revision != graph->style_revision() )
+    {
+        m_style.reset_style(m_wrapped_node->style());
+        m_style_revision = graph->style_revision();
+    }
+    return &m_style;
+}
+
 void Script_Node::set_style(QObject *object)
 {
 
@@ -54,6 +54,7 @@ class Script_Node : public QObject
     Node* m_wrapped_node;
     Script_Graph* graph;
     Script_Node_Style m_style;
+    unsigned          m_style_revision; ///< Script_Graph::style_revision() at last sync
 
 public:
     Script_Node(Node* n, Script_Graph* graph);
@@ -86,7 +87,7 @@ public:
 
     Q_INVOKABLE bool compare(Script_Node *n) const;
 
-    Script_Node_Style* style() { return &m_style; }
+    Script_Node_Style* style();
     void set_style(QObject* style);
 
 signals:
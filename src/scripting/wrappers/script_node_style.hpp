@@ -64,6 +64,13 @@ public:
      */
     void from_style(Node_Style style);
 
+    /**
+     * \brief Replace the wrapped style without emitting changed()
+     *
+     * Used to keep long-lived wrappers in sync with the wrapped object
+     */
+    void reset_style(Node_Style style) { wrapped = style; }
+
     /**
      * \brief Disable all customized style features
      */
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "script_renderer.hpp"
 #include "image_exporter.hpp"
 #include "xml_exporter.hpp"
+#include "knot_view.hpp"
 #include <QBuffer>
 
 
@@ -44,6 +45,8 @@ QString Script_Renderer::svg()
     QByteArray out_raw;
     QBuffer out(&out_raw);
     out.open(QIODevice::WriteOnly|QIODevice::Text);
+    if ( view )
+        view->flush_render();
     export_svg(out,*graph,m_draw_graph);
     return out_raw;
 }
@@ -65,6 +68,9 @@ QByteArray Script_Renderer::raster(int width, int height, QString format, int qu
         height = actual_size.height()*width/actual_size.width();
     }
 
+    if ( view )
+        view->flush_render();
+
     QByteArray out_raw;
     QBuffer out(&out_raw);
     out.open(QIODevice::WriteOnly);
@@ -73,6 +79,36 @@ QByteArray Script_Renderer::raster(int width, int height, QString format, int qu
     return out_raw;
 }
 
+QVariantMap Script_Renderer::stats() const
+{
+    const Render_Stats& stats = graph->render_stats();
+    QVariantMap map;
+    map["render"] = stats.render()/1e6;
+    map["traversal"] = stats.traverse/1e6;
+    map["path_build"] = stats.path_build/1e6;
+    map["bounding_box"] = stats.bounding_box/1e6;
+    map["paint"] = stats.paint/1e6;
+    map["renders"] = stats.renders;
+    map["nodes"] = graph->nodes().size();
+    map["edges"] = graph->edges().size();
+    map["loops"] = stats.loops;
+    map["segments"] = stats.segments;
+    if ( view )
+        map["paints_per_second"] = view->paints_per_second();
+    return map;
+}
+
+bool Script_Renderer::show_stats() const
+{
+    return view && view->show_render_stats();
+}
+
+void Script_Renderer::set_show_stats(bool show)
+{
+    if ( view )
+        view->set_show_render_stats(show);
+}
+
 QString Script_Renderer::toString()
 {
     return "[renderer]";
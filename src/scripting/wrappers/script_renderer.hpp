@@ -28,9 +28,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define SCRIPT_RENDERER_HPP
 
 #include <QObject>
+#include <QVariantMap>
 #include "graph.hpp"
 #include "script_color.hpp"
 
+class Knot_View;
+
 /**
  * Document renderer
  */
@@ -39,17 +42,33 @@ class Script_Renderer : public QObject
     Q_OBJECT
 
     Q_PROPERTY(bool draw_graph READ draw_graph WRITE set_draw_graph)
+    Q_PROPERTY(QVariantMap stats READ stats)
+    Q_PROPERTY(bool show_stats READ show_stats WRITE set_show_stats)
 
 private:
     const Graph* graph;
+    Knot_View* view; ///< View displaying graph, its deferred renders are flushed before exporting
     bool m_draw_graph;
 
 public:
-    Script_Renderer(const Graph* graph) : graph(graph), m_draw_graph(false) {}
+    Script_Renderer(const Graph* graph, Knot_View* view = nullptr)
+        : graph(graph), view(view), m_draw_graph(false) {}
 
     bool draw_graph() const { return m_draw_graph; }
     void set_draw_graph( bool draw ) { m_draw_graph = draw; }
 
+    /**
+     * \brief Statistics of the last render and paint
+     *
+     * Times are in milliseconds, paints_per_second is available only
+     * for documents shown in a view
+     */
+    QVariantMap stats() const;
+
+    /// Whether the view shows the statistics overlay
+    bool show_stats() const;
+    void set_show_stats(bool show);
+
     /**
      * \brief Render as knot file (XML)
      */
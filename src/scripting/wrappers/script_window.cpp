@@ -37,11 +37,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 Script_Window::Script_Window(Main_Window *window, QObject *parent) :
-    QObject(parent), window(window), m_dialog(window)
+    QObject(parent), window(window), m_dialog(window), m_deferred_render(false)
 {
     connect(window,SIGNAL(tab_closing(Knot_View*)),SLOT(close_tab(Knot_View*)));
 }
 
+Script_Window::~Script_Window()
+{
+    // Documents end their macros before the views render again
+    qDeleteAll(docs);
+    docs.clear();
+    qDeleteAll(deferred);
+}
+
 bool Script_Window::open(QString name)
 {
     return window->create_tab(name);
@@ -74,6 +82,8 @@ Script_Document* Script_Window::document()
     {
         Script_Document* doc = new Script_Document(window->view,this);
         connect(doc,SIGNAL(style_changed()),window,SLOT(update_style()));
+        if ( m_deferred_render && !deferred.contains(window->view) )
+            deferred[window->view] = new Deferred_Render(window->view);
         docs[window->view] = doc;
     }
 
@@ -97,6 +107,7 @@ void Script_Window::close_tab(Knot_View *view)
         delete docs[view];
         docs.remove(view);
     }
+    delete deferred.take(view);
 }
 
 void Script_Window::screenshot(QString output_image_file, QString widget)
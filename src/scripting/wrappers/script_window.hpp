@@ -98,9 +98,20 @@ class Script_Window : public QObject
 
     Main_Window* window;
     QMap<Knot_View*,Script_Document*> docs;
+    QMap<Knot_View*,Deferred_Render*> deferred; ///< Views suspended by set_deferred_render()
     Script_Window_Dialog m_dialog;
+    bool m_deferred_render;
 public:
     explicit Script_Window(Main_Window* window, QObject *parent = 0);
+    ~Script_Window();
+
+    /**
+     * \brief Suspend rendering of the documents accessed by scripts
+     *
+     * Affects documents requested after this call, rendering resumes
+     * when this object is destroyed, or when the tab is closed.
+     */
+    void set_deferred_render(bool deferred) { m_deferred_render = deferred; }
 
     Q_INVOKABLE bool open(QString name=QString());
     QString current_file() const;
@@ -40,6 +40,7 @@ Settings::Settings()
       m_save_ui(true), m_icon_size(22), tool_button_style(Qt::ToolButtonIconOnly),
       m_max_recent_files(5),
       m_graph_cache(false), m_fluid_refresh(true), m_antialiasing(true), m_script_timeout(0),
+      m_autosave_interval(2), m_script_log_lines(1000), m_script_log_file(false),
       m_save_grid(true), m_grid_enabled(true), m_grid_size(32), m_grid_shape(Snapping_Grid::SQUARE),
       m_check_unsaved_files(true),
       m_save_knot_style(false),
@@ -66,6 +67,9 @@ void Settings::load_config()
     m_fluid_refresh = settings.value("performance/fluid_refresh",m_fluid_refresh).toBool();
     m_antialiasing = settings.value("performance/antialiasing",m_antialiasing).toBool();
     m_script_timeout = settings.value("performance/script_timeout",m_script_timeout).toInt();
+    m_autosave_interval = settings.value("autosave/interval",m_autosave_interval).toInt();
+    set_script_log_lines(settings.value("script/log_lines",m_script_log_lines).toInt());
+    m_script_log_file = settings.value("script/log_file",m_script_log_file).toBool();
 
     m_save_knot_style = settings.value("style/save",m_save_knot_style).toBool();
     saved_knot_style_xml = settings.value("style/xml",saved_knot_style_xml).toString();
@@ -181,6 +185,9 @@ void Settings::save_config()
     settings.setValue("performance/fluid_refresh",m_fluid_refresh);
     settings.setValue("performance/antialiasing",m_antialiasing);
     settings.setValue("performance/script_timeout",m_script_timeout);
+    settings.setValue("autosave/interval",m_autosave_interval);
+    settings.setValue("script/log_lines",m_script_log_lines);
+    settings.setValue("script/log_file",m_script_log_file);
 
     settings.setValue("style/save",m_save_knot_style);
     settings.setValue("style/xml",saved_knot_style_xml);
@@ -396,6 +403,11 @@ QString Settings::settings_file() const
     return QSettings(TARGET,TARGET).fileName();
 }
 
+QString Settings::script_log_file_name() const
+{
+    return resource_manager().program.writable_data_directory("script.log");
+}
+
 QKeySequence Settings::default_shortcut(QString action_name)
 {
     if ( m_action_default.contains(action_name) )
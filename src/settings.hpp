@@ -73,6 +73,9 @@ private:
     bool                        m_fluid_refresh;
     bool                        m_antialiasing;
     int                         m_script_timeout;
+    int                         m_autosave_interval; ///< Minutes between recovery snapshots, 0 to disable
+    int                         m_script_log_lines;  ///< Script output entries kept while waiting to be displayed
+    bool                        m_script_log_file;   ///< Whether script output is also written to script_log_file_name()
 
     bool                        m_save_grid;
     bool                        m_grid_enabled;
@@ -125,6 +128,16 @@ public:
     void set_antialiasing(bool enable) { m_antialiasing = enable; }
     void set_script_timeout(int seconds) { m_script_timeout = seconds; }
 
+    int  autosave_interval() const { return m_autosave_interval; }
+    void set_autosave_interval(int minutes) { m_autosave_interval = minutes; }
+
+    int  script_log_lines() const { return m_script_log_lines; }
+    void set_script_log_lines(int lines) { m_script_log_lines = qMax(1,lines); }
+    bool script_log_file() const { return m_script_log_file; }
+    void set_script_log_file(bool enable) { m_script_log_file = enable; }
+    /// File receiving the full script output when script_log_file() is enabled
+    QString script_log_file_name() const;
+
     bool save_ui() const { return m_save_ui; }
     void set_save_ui(bool save) { m_save_ui = save; }
 
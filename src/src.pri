@@ -36,6 +36,8 @@ SOURCES += \
     $$PWD/settings.cpp \
     $$PWD/string_toolbar.cpp \
     $$PWD/command_line.cpp \
+    $$PWD/startup_profile.cpp \
+    $$PWD/trace.cpp \
     src/application_info.cpp \
     src/resource_script.cpp
 
@@ -45,5 +47,7 @@ HEADERS += \
     $$PWD/string_toolbar.hpp \
     $$PWD/c++.hpp \
     $$PWD/command_line.hpp \
+    $$PWD/startup_profile.hpp \
+    $$PWD/trace.hpp \
     src/application_info.hpp \
     src/resource_script.hpp
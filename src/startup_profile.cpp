@@ -0,0 +1,277 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "startup_profile.hpp"
+#include <cstdlib>
+#include <new>
+
+#if QT_VERSION >= 0x050300
+#include <QAtomicInteger>
+/// Lock-free 64 bit counter
+class Allocation_Counter
+{
+    QAtomicInteger<qint64> value;
+
+public:
+    void add(qint64 delta) { value.fetchAndAddRelaxed(delta); }
+    qint64 load() { return value.fetchAndAddRelaxed(0); }
+};
+#else
+#include <QAtomicInt>
+/**
+ * \brief Lock-free 64 bit counter for Qt versions without QAtomicInteger
+ *
+ * The low 32 bits wrap around and carry into the high word.
+ * A concurrent load() may miss a carry that is in flight, which is fine
+ * for a profile.
+ */
+class Allocation_Counter
+{
+    QAtomicInt low;
+    QAtomicInt high;
+
+public:
+    void add(qint64 delta)
+    {
+        quint32 delta_low = quint32(quint64(delta));
+        quint32 old_low = quint32(low.fetchAndAddRelaxed(int(delta_low)));
+        int carry = int(quint64(delta) >> 32);
+        if ( quint32(old_low + delta_low) < old_low )
+            carry++;
+        if ( carry )
+            high.fetchAndAddRelaxed(carry);
+    }
+
+    qint64 load()
+    {
+        int h, l;
+        do
+        {
+            h = high.fetchAndAddRelaxed(0);
+            l = low.fetchAndAddRelaxed(0);
+        }
+        while ( h != high.fetchAndAddRelaxed(0) );
+        return qint64((quint64(quint32(h)) << 32) | quint32(l));
+    }
+};
+#endif
+
+static volatile bool counting_allocations = false;
+static Allocation_Counter allocation_counter;
+static Allocation_Counter byte_counter;
+
+// Enabled with qmake CONFIG+=startup_alloc_count
+#ifdef STARTUP_ALLOCATION_COUNT
+
+#if __cplusplus >= 201103
+#   define THROW_BAD_ALLOC
+#   define THROW_NOTHING noexcept
+#else
+#   define THROW_BAD_ALLOC throw(std::bad_alloc)
+#   define THROW_NOTHING throw()
+#endif
+
+/*
+    Replacing the global allocation functions is the only portable way to see
+    allocations performed by Qt, the overhead is a single branch unless the
+    startup profile is enabled.
+*/
+static void* counted_malloc(std::size_t size)
+{
+    if ( counting_allocations )
+    {
+        allocation_counter.add(1);
+        byte_counter.add(qint64(size));
+    }
+
+    void* p = std::malloc(size ? size : 1);
+    if ( !p )
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) THROW_BAD_ALLOC
+{
+    return counted_malloc(size);
+}
+
+void* operator new[](std::size_t size) THROW_BAD_ALLOC
+{
+    return counted_malloc(size);
+}
+
+void operator delete(void* p) THROW_NOTHING
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) THROW_NOTHING
+{
+    std::free(p);
+}
+
+#endif // STARTUP_ALLOCATION_COUNT
+
+
+Startup_Profile::Startup_Profile()
+    : m_enabled(false), m_frame_painted(false), current(-1)
+{
+}
+
+Startup_Profile &Startup_Profile::instance()
+{
+    static Startup_Profile singleton;
+    return singleton;
+}
+
+void Startup_Profile::enable()
+{
+    if ( m_enabled )
+        return;
+
+    m_enabled = true;
+    phases.push_back(Phase());
+    phases[0].name = "Startup";
+    current = 0;
+    timer.start();
+    counting_allocations = true;
+}
+
+int Startup_Profile::begin(const QString &name)
+{
+    if ( !m_enabled )
+        return -1;
+
+    foreach ( int child, phases[current].children )
+    {
+        if ( phases[child].name == name )
+        {
+            current = child;
+            return child;
+        }
+    }
+
+    Phase phase;
+    phase.name = name;
+    phase.parent = current;
+    phases.push_back(phase);
+    int index = phases.size()-1;
+    phases[current].children.push_back(index);
+    current = index;
+    return index;
+}
+
+void Startup_Profile::end(int phase, qint64 start, qint64 allocations, qint64 bytes)
+{
+    if ( phase < 0 || phase >= phases.size() )
+        return;
+
+    Phase& p = phases[phase];
+    p.elapsed += now() - start;
+    p.allocations += allocation_count() - allocations;
+    p.bytes += allocated_bytes() - bytes;
+    current = p.parent;
+}
+
+qint64 Startup_Profile::now() const
+{
+    if ( !timer.isValid() )
+        return 0;
+#if HAS_QT_4_8
+    return timer.nsecsElapsed();
+#else
+    return timer.elapsed()*1000000;
+#endif
+}
+
+qint64 Startup_Profile::allocation_count()
+{
+    return allocation_counter.load();
+}
+
+qint64 Startup_Profile::allocated_bytes()
+{
+    return byte_counter.load();
+}
+
+void Startup_Profile::print(std::ostream &out) const
+{
+    if ( phases.empty() )
+        return;
+
+    // The root phase is never closed by a timer
+    Phase root = phases[0];
+    root.elapsed = now();
+    root.allocations = allocation_count();
+    root.bytes = allocated_bytes();
+
+    out << QString("%1 %2 %3 %4\n")
+            .arg("Phase",-40).arg("ms",10).arg("allocs",10).arg("KiB",10)
+            .toStdString();
+    print(out,root,0);
+    out.flush();
+}
+
+void Startup_Profile::print(std::ostream &out, const Phase& phase, int depth) const
+{
+    out << QString("%1%2 %3 %4 %5\n")
+            .arg(QString(depth*2,' '))
+            .arg(phase.name,-(40-depth*2))
+            .arg(phase.elapsed/1e6,10,'f',2)
+            .arg(phase.allocations,10)
+            .arg(phase.bytes/1024,10)
+            .toStdString();
+
+    foreach ( int child, phase.children )
+        print(out,phases[child],depth+1);
+}
+
+
+Startup_Timer::Startup_Timer(const char *name)
+    : phase(-1), start(0), allocations(0), bytes(0)
+{
+    Startup_Profile& profile = Startup_Profile::instance();
+    if ( profile.is_enabled() )
+    {
+        phase = profile.begin(QString::fromLatin1(name));
+        allocations = Startup_Profile::allocation_count();
+        bytes = Startup_Profile::allocated_bytes();
+        start = profile.now();
+    }
+}
+
+Startup_Timer::~Startup_Timer()
+{
+    stop();
+}
+
+void Startup_Timer::stop()
+{
+    if ( phase >= 0 )
+    {
+        Startup_Profile::instance().end(phase,start,allocations,bytes);
+        phase = -1;
+    }
+}
@@ -0,0 +1,148 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef STARTUP_PROFILE_HPP
+#define STARTUP_PROFILE_HPP
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <ostream>
+#include "c++.hpp"
+
+/**
+ * \brief Collects wall time and allocations for the phases of application startup
+ *
+ * Phases are opened and closed by Startup_Timer and form a tree,
+ * phases with the same name under the same parent are merged.
+ *
+ * \note Data is collected only after enable() has been called and
+ *       timers must be used from the GUI thread.
+ *       Allocations are counted on all threads.
+ */
+class Startup_Profile
+{
+    struct Phase
+    {
+        QString     name;
+        int         parent;
+        QList<int>  children;
+        qint64      elapsed;    ///< Nanoseconds
+        qint64      allocations;
+        qint64      bytes;
+
+        Phase() : parent(-1), elapsed(0), allocations(0), bytes(0) {}
+    };
+
+    bool            m_enabled;
+    bool            m_frame_painted;
+    QElapsedTimer   timer;
+    QVector<Phase>  phases;     ///< phases[0] is the whole startup
+    int             current;
+
+    Startup_Profile();
+    Startup_Profile(const Startup_Profile&);
+
+public:
+    static Startup_Profile& instance();
+
+    /**
+     * \brief Start collecting data
+     *
+     * Should be called as early as possible, the root phase starts here
+     */
+    void enable();
+
+    bool is_enabled() const { return m_enabled; }
+
+    /**
+     * \brief Open a child of the current phase
+     * \return Index of the opened phase or -1 if profiling is disabled
+     */
+    int begin(const QString& name);
+
+    /**
+     * \brief Close the given phase, adding the elapsed time and allocations
+     */
+    void end(int phase, qint64 start, qint64 allocations, qint64 bytes);
+
+    /// Nanoseconds since enable()
+    qint64 now() const;
+
+    /// Called by the knot view when it paints
+    void mark_frame_painted() { m_frame_painted = true; }
+
+    /// Whether a knot view has been painted
+    bool frame_painted() const { return m_frame_painted; }
+
+    /// Print the phase tree
+    void print(std::ostream& out) const;
+
+    /**
+     * \brief Number of allocations performed while profiling
+     * \note Always 0 unless the build defines STARTUP_ALLOCATION_COUNT
+     *       (qmake CONFIG+=startup_alloc_count), which replaces the global
+     *       operator new in startup_profile.cpp
+     */
+    static qint64 allocation_count();
+    static qint64 allocated_bytes();
+
+private:
+    void print(std::ostream& out, const Phase& phase, int depth) const;
+};
+
+/**
+ * \brief Scoped timer for a startup phase
+ *
+ * Does nothing unless the startup profile is enabled.
+ * \code
+ *  {
+ *      Startup_Timer timer("Plugins");
+ *      load_plugins();
+ *  }
+ * \endcode
+ */
+class Startup_Timer
+{
+    int     phase;
+    qint64  start;
+    qint64  allocations;
+    qint64  bytes;
+
+public:
+    explicit Startup_Timer(const char* name);
+    ~Startup_Timer();
+
+    /// Close the phase before the end of the scope
+    void stop();
+
+private:
+    Startup_Timer(const Startup_Timer&);
+    Startup_Timer& operator=(const Startup_Timer&);
+};
+
+#endif // STARTUP_PROFILE_HPP
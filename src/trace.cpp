@@ -0,0 +1,153 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "trace.hpp"
+#include <QThread>
+#include <QFile>
+#include <QTextStream>
+#include <QCoreApplication>
+
+volatile bool Trace::m_recording = false;
+
+Trace::Trace() : dropped(0)
+{
+}
+
+Trace &Trace::instance()
+{
+    static Trace singleton;
+    return singleton;
+}
+
+void Trace::start()
+{
+    QMutexLocker lock(&mutex);
+    events.clear();
+    threads.clear();
+    dropped = 0;
+    timer.start();
+    m_recording = true;
+}
+
+void Trace::stop()
+{
+    QMutexLocker lock(&mutex);
+    m_recording = false;
+}
+
+qint64 Trace::now() const
+{
+#if HAS_QT_4_8
+    return timer.nsecsElapsed() / 1000;
+#else
+    return timer.elapsed() * 1000;
+#endif
+}
+
+void Trace::record(const char *name, qint64 start)
+{
+    qint64 end = now();
+    Qt::HANDLE thread_id = QThread::currentThreadId();
+
+    QMutexLocker lock(&mutex);
+    if ( !m_recording )
+        return;
+
+    if ( events.size() >= max_events )
+    {
+        dropped++;
+        return;
+    }
+
+    QHash<Qt::HANDLE,int>::iterator thread = threads.find(thread_id);
+    if ( thread == threads.end() )
+        thread = threads.insert(thread_id,threads.size()+1);
+
+    Event event;
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+    event.thread = *thread;
+    events.push_back(event);
+}
+
+int Trace::event_count() const
+{
+    QMutexLocker lock(&mutex);
+    return events.size();
+}
+
+/// Names are literals so only quotes and backslashes need escaping
+static QString json_string(const char* text)
+{
+    QString escaped = QString::fromLatin1(text);
+    escaped.replace('\\',"\\\\");
+    escaped.replace('"',"\\\"");
+    return '"'+escaped+'"';
+}
+
+bool Trace::save(QIODevice &file) const
+{
+    if ( !file.isOpen() && !file.open(QIODevice::WriteOnly|QIODevice::Text) )
+        return false;
+
+    QMutexLocker lock(&mutex);
+
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\n\"traceEvents\":[\n";
+
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+           "\"args\":{\"name\":\""
+        << QCoreApplication::applicationName().replace('"','\'') << "\"}}";
+
+    for ( QHash<Qt::HANDLE,int>::const_iterator i = threads.begin();
+            i != threads.end(); ++i )
+    {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << i.value() << ",\"args\":{\"name\":\"Thread " << i.value()
+            << "\"}}";
+    }
+
+    foreach ( const Event& event, events )
+    {
+        out << ",\n{\"name\":" << json_string(event.name)
+            << ",\"cat\":\"knotter\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << event.thread << ",\"ts\":" << event.start
+            << ",\"dur\":" << event.duration << "}";
+    }
+
+    out << "\n],\n\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+    out.flush();
+
+    return out.status() == QTextStream::Ok;
+}
+
+bool Trace::save(const QString &file_name) const
+{
+    QFile file(file_name);
+    if ( !file.open(QIODevice::WriteOnly|QIODevice::Text) )
+        return false;
+    return save(file);
+}
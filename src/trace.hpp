@@ -0,0 +1,146 @@
+/**
+  
+\file
+
+\author Mattia Basaglia
+
+\section License
+This file is part of Knotter.
+
+Copyright (C) 2012-2014  Mattia Basaglia
+
+Knotter is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Knotter is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include <QIODevice>
+#include "c++.hpp"
+
+/**
+ * \brief Records timed events in the Chrome trace event format
+ *
+ * The resulting JSON file can be opened with chrome://tracing or
+ * https://ui.perfetto.dev
+ *
+ * Events are recorded by Trace_Scope only between start() and stop(),
+ * recording is thread safe.
+ */
+class Trace
+{
+    struct Event
+    {
+        const char* name;
+        qint64      start;      ///< Microseconds since start()
+        qint64      duration;   ///< Microseconds
+        int         thread;
+    };
+
+    static volatile bool    m_recording;
+    QElapsedTimer           timer;
+    mutable QMutex          mutex;
+    QVector<Event>          events;
+    QHash<Qt::HANDLE,int>   threads;
+    int                     dropped;
+
+    Trace();
+    Trace(const Trace&);
+
+public:
+    /// Maximum number of events kept for a single recording
+    static const int max_events = 1000000;
+
+    static Trace& instance();
+
+    /// Whether events are being recorded
+    static bool recording() { return m_recording; }
+
+    /**
+     * \brief Discard previous events and start recording
+     */
+    void start();
+
+    /**
+     * \brief Stop recording, the events are kept until the next start()
+     */
+    void stop();
+
+    /// Microseconds since start()
+    qint64 now() const;
+
+    /**
+     * \brief Add a complete event
+     * \param name  Event name, must be a string literal
+     * \param start Value of now() when the event began
+     */
+    void record(const char* name, qint64 start);
+
+    /// Number of recorded events
+    int event_count() const;
+
+    /**
+     * \brief Write the recorded events as trace event JSON
+     */
+    bool save(QIODevice& file) const;
+    bool save(const QString& file_name) const;
+};
+
+/**
+ * \brief Scoped trace event
+ *
+ * Use the TRACE_SCOPE macro so that tracing can be compiled out by defining
+ * \c NO_TRACE
+ */
+class Trace_Scope
+{
+    const char* name;
+    qint64      start;
+
+public:
+    explicit Trace_Scope(const char* name)
+        : name(name), start(Trace::recording() ? Trace::instance().now() : -1)
+    {}
+
+    ~Trace_Scope()
+    {
+        if ( start >= 0 && Trace::recording() )
+            Trace::instance().record(name,start);
+    }
+
+private:
+    Trace_Scope(const Trace_Scope&);
+    Trace_Scope& operator=(const Trace_Scope&);
+};
+
+#define TRACE_CONCAT_IMPL(a,b) a##b
+#define TRACE_CONCAT(a,b) TRACE_CONCAT_IMPL(a,b)
+
+#ifdef NO_TRACE
+#   define TRACE_SCOPE(name)
+#else
+/**
+ * \brief Record an event lasting until the end of the current scope
+ * \param name String literal
+ */
+#   define TRACE_SCOPE(name) Trace_Scope TRACE_CONCAT(trace_scope_,__LINE__)(name)
+#endif
+
+#endif // TRACE_HPP
@@ -26,9 +26,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "background_image.hpp"
 #include <QPainter>
+#include <qmath.h>
+
+/// Cost of a tile in the cache, in KiB
+static const int tile_cost = Background_Image::tile_size*Background_Image::tile_size*4/1024;
 
 Background_Image::Background_Image()
-    : enabled(false), scale(1)
+    : enabled(false), scale(1), tiles(64*1024), tile_scale(0)
 {
 }
 
@@ -36,12 +40,109 @@ void Background_Image::render(QPainter *painter) const
 {
     if ( enabled && ! image.isNull() )
     {
-        painter->drawPixmap(pos.x(),pos.y(),
-                            image.width()*scale, image.height()*scale,
-                            image );
+        painter->drawImage(QRectF(pos.x(),pos.y(),
+                                  image.width()*scale, image.height()*scale),
+                           image );
+    }
+}
+
+void Background_Image::render(QPainter *painter, const QRectF &exposed) const
+{
+    if ( !enabled || image.isNull() )
+        return;
+
+    QTransform transform = painter->worldTransform();
+    if ( transform.type() > QTransform::TxScale || transform.m11() <= 0 ||
+            !qFuzzyCompare(transform.m11(),transform.m22()) )
+    {
+        double device_scale = qSqrt(qAbs(transform.determinant()))*scale;
+        const QImage& level = level_for_scale(device_scale);
+        painter->drawImage(QRectF(pos.x(),pos.y(),
+                                  image.width()*scale, image.height()*scale),
+                           level );
+        return;
+    }
+
+    double device_scale = transform.m11()*scale;
+    if ( device_scale != tile_scale )
+    {
+        tiles.clear();
+        tile_scale = device_scale;
+    }
+
+    // Tiles are aligned to the image corner, rounded to the closest pixel
+    QPoint origin = transform.map(pos).toPoint();
+    QRect image_rect(0, 0, qCeil(image.width()*device_scale),
+                     qCeil(image.height()*device_scale));
+    QRect target = transform.mapRect(exposed).toAlignedRect().translated(-origin)
+                    & image_rect;
+    if ( target.isEmpty() )
+        return;
+
+    painter->save();
+    painter->resetTransform();
+    for ( int y = target.top()/tile_size; y <= target.bottom()/tile_size; y++ )
+    {
+        for ( int x = target.left()/tile_size; x <= target.right()/tile_size; x++ )
+        {
+            quint64 key = (quint64(x) << 32) | quint64(y);
+            QPixmap* tile = tiles.object(key);
+            if ( !tile )
+            {
+                tile = new QPixmap(make_tile(x,y));
+                tiles.insert(key,tile,tile_cost);
+            }
+            painter->drawPixmap(origin+QPoint(x*tile_size,y*tile_size),*tile);
+        }
+    }
+    painter->restore();
+}
+
+void Background_Image::update_levels()
+{
+    mip_levels.clear();
+    tiles.clear();
+    tile_scale = 0;
+
+    QImage level = image;
+    while ( level.width() > tile_size || level.height() > tile_size )
+    {
+        level = level.scaled(qMax(1,level.width()/2),qMax(1,level.height()/2),
+                             Qt::IgnoreAspectRatio,Qt::SmoothTransformation);
+        mip_levels.push_back(level);
     }
 }
 
+const QImage &Background_Image::level_for_scale(double device_scale) const
+{
+    int level = 0;
+    while ( level < mip_levels.size() && device_scale*2 <= 1 )
+    {
+        device_scale *= 2;
+        level++;
+    }
+    return level == 0 ? image : mip_levels[level-1];
+}
+
+QPixmap Background_Image::make_tile(int tile_x, int tile_y) const
+{
+    const QImage& source = level_for_scale(tile_scale);
+
+    QImage tile(tile_size,tile_size,QImage::Format_ARGB32_Premultiplied);
+    tile.fill(0);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.translate(-tile_x*tile_size,-tile_y*tile_size);
+    painter.scale(tile_scale*image.width()/source.width(),
+                  tile_scale*image.height()/source.height());
+    // Only the pixels covered by the tile are sampled
+    painter.drawImage(0,0,source);
+    painter.end();
+
+    return QPixmap::fromImage(tile);
+}
+
 
 void Background_Image::enable(bool enabled)
 {
@@ -52,6 +153,7 @@ void Background_Image::enable(bool enabled)
 void Background_Image::load_file(QString name)
 {
     image.load(name);
+    update_levels();
     file = name;
     emit changed();
 }
@@ -27,22 +27,49 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef BACKGROUND_IMAGE_HPP
 #define BACKGROUND_IMAGE_HPP
 #include <QPixmap>
+#include <QImage>
+#include <QVector>
+#include <QCache>
 
 class Background_Image: public QObject
 {
     Q_OBJECT
 private:
-    QPixmap image;
+    QImage  image;
     QPointF pos;
     bool    enabled;
     QString file;
     double  scale;
 
+    /// Downsampled copies of image, each half the size of the previous one
+    QVector<QImage> mip_levels;
+
+    /// Tiles of the image scaled to device pixels, keyed by tile coordinates
+    mutable QCache<quint64,QPixmap> tiles;
+    mutable double  tile_scale; ///< Device pixels per image pixel of the tiles
+
 public:
+    /// Size in device pixels of the cached tiles
+    static const int tile_size = 256;
+
     Background_Image();
 
+    /**
+     * \brief Draw the whole image at full resolution
+     *
+     * Used when the output doesn't map to screen pixels (eg: exports)
+     */
     void render (QPainter *painter) const;
 
+    /**
+     * \brief Draw the part of the image in the exposed rect
+     *
+     * Draws from cached tiles pre-scaled for the painter transformation,
+     * falls back to render(painter) if the transformation isn't a plain
+     * scale and translation.
+     */
+    void render (QPainter *painter, const QRectF& exposed) const;
+
     bool is_enabled () const { return enabled; }
     QString file_name() const { return file; }
     QPointF position() const { return pos; }
@@ -63,6 +90,19 @@ public slots:
 signals:
     void changed();
     void moved(QPointF);
+
+private:
+    /// Build mip_levels from image and discard cached tiles
+    void update_levels();
+
+    /**
+     * \brief Smallest of image and mip_levels that has at least
+     *        device_scale pixels for each device pixel
+     */
+    const QImage& level_for_scale(double device_scale) const;
+
+    /// Render a tile of the image scaled to tile_scale
+    QPixmap make_tile(int tile_x, int tile_y) const;
 };
 
 #endif // BACKGROUND_IMAGE_HPP
@@ -598,17 +598,23 @@ bool Node_Style_Basic_Double_Parameter::mergeWith(const QUndoCommand *other)
 int Node_Style_Handle_Lenght::m_id = generate_id();
 void Node_Style_Handle_Lenght::apply(Node* node, double value)
 {
-    node->style().handle_length = value;
+    Node_Style style = node->style();
+    style.handle_length = value;
+    node->set_style(style);
 }
 int Node_Style_Cusp_Distance::m_id = generate_id();
 void Node_Style_Cusp_Distance::apply(Node* node, double value)
 {
-    node->style().cusp_distance = value;
+    Node_Style style = node->style();
+    style.cusp_distance = value;
+    node->set_style(style);
 }
 int Node_Style_Cusp_Angle::m_id = generate_id();
 void Node_Style_Cusp_Angle::apply(Node* node, double value)
 {
-    node->style().cusp_angle = value;
+    Node_Style style = node->style();
+    style.cusp_angle = value;
+    node->set_style(style);
 }
 
 
@@ -622,13 +628,21 @@ Node_Style_Cusp_Shape::Node_Style_Cusp_Shape(
 void Node_Style_Cusp_Shape::undo()
 {
     for( int i = 0; i < nodes.size(); i++)
-        nodes[i]->style().cusp_shape = before[i];
+    {
+        Node_Style style = nodes[i]->style();
+        style.cusp_shape = before[i];
+        nodes[i]->set_style(style);
+    }
     update_knot();
 }
 void Node_Style_Cusp_Shape::redo()
 {
     for( int i = 0; i < nodes.size(); i++)
-        nodes[i]->style().cusp_shape = after[i];
+    {
+        Node_Style style = nodes[i]->style();
+        style.cusp_shape = after[i];
+        nodes[i]->set_style(style);
+    }
     update_knot();
 }
 
@@ -657,13 +671,21 @@ Node_Style_Enable::Node_Style_Enable(Node *node,
 void Node_Style_Enable::undo()
 {
     for( int i = 0; i < nodes.size(); i++)
-        nodes[i]->style().enabled_style = before[i];
+    {
+        Node_Style style = nodes[i]->style();
+        style.enabled_style = before[i];
+        nodes[i]->set_style(style);
+    }
     update_knot();
 }
 void Node_Style_Enable::redo()
 {
     for( int i = 0; i < nodes.size(); i++)
-        nodes[i]->style().enabled_style = after[i];
+    {
+        Node_Style style = nodes[i]->style();
+        style.enabled_style = after[i];
+        nodes[i]->set_style(style);
+    }
     update_knot();
 }
 
@@ -801,7 +823,9 @@ bool Edge_Style_Basic_Double_Parameter::mergeWith(const QUndoCommand *other)
 int Edge_Style_Crossing_Distance::m_id = generate_id();
 void Edge_Style_Crossing_Distance::apply(Edge* edge, double value)
 {
-    edge->style().crossing_distance = value;
+    Edge_Style style = edge->style();
+    style.crossing_distance = value;
+    edge->set_style(style);
 }
 
 
@@ -829,13 +853,21 @@ Edge_Style_Enable::Edge_Style_Enable(Edge *edge,
 void Edge_Style_Enable::undo()
 {
     for( int i = 0; i < edges.size(); i++)
-        edges[i]->style().enabled_style = before[i];
+    {
+        Edge_Style style = edges[i]->style();
+        style.enabled_style = before[i];
+        edges[i]->set_style(style);
+    }
     update_knot();
 }
 void Edge_Style_Enable::redo()
 {
     for( int i = 0; i < edges.size(); i++)
-        edges[i]->style().enabled_style = after[i];
+    {
+        Edge_Style style = edges[i]->style();
+        style.enabled_style = after[i];
+        edges[i]->set_style(style);
+    }
     update_knot();
 }
 
@@ -843,14 +875,18 @@ void Edge_Style_Enable::redo()
 int Edge_Style_Edge_Slide::m_id = generate_id();
 void Edge_Style_Edge_Slide::apply(Edge *edge, double value)
 {
-    edge->style().edge_slide = value;
+    Edge_Style style = edge->style();
+    style.edge_slide = value;
+    edge->set_style(style);
 }
 
 
 int Edge_Style_Handle_Lenght::m_id = generate_id();
 void Edge_Style_Handle_Lenght::apply(Edge *edge, double value)
 {
-    edge->style().handle_length = value;
+    Edge_Style style = edge->style();
+    style.handle_length = value;
+    edge->set_style(style);
 }
 
 
@@ -35,6 +35,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "context_menu_node.hpp"
 #include "context_menu_edge.hpp"
 #include <QFile>
+#include "trace.hpp"
+#include "startup_profile.hpp"
 //#include <QGLWidget>
 
 Knot_View::Knot_View(QString file)
@@ -43,12 +45,18 @@ Knot_View::Knot_View(QString file)
       context_menu_node(new Context_Menu_Node(this)),
       context_menu_edge(new Context_Menu_Edge(this)),
       active_tool(nullptr), tool_select(this,&m_graph),
-      tool_edge_chain(this,&m_graph),tool_toggle_edge(this,&m_graph)
+      tool_edge_chain(this,&m_graph),tool_toggle_edge(this,&m_graph),
+      selection_notify_pending(false), render_suspended(0), render_pending(false),
+      selection_pending(false), selection_edges_pending(false),
+      m_show_render_stats(false), update_mode(MinimalViewportUpdate),
+      m_revision(0)
 {
+    paint_clock.start();
     //setViewport(new QGLWidget);
 
     connect(&resource_manager().script,SIGNAL(plugins_changed()),
             SLOT(check_plugins()));
+    connect(&undo_stack,SIGNAL(indexChanged(int)),SLOT(bump_revision()));
 
     tool_edge_chain.set_graph(&m_graph);
     tool_select.set_graph(&m_graph);
@@ -63,6 +71,7 @@ Knot_View::Knot_View(QString file)
     scene->setItemIndexMethod(QGraphicsScene::NoIndex);
     setSceneRect ( -width(), -height(), width()*2, height()*2);
     setScene(scene);
+    Graph_Item::set_selection_observer(scene,this);
     setMouseTracking(true);
     setRenderHint(QPainter::Antialiasing);
     setTransformationAnchor(NoAnchor);
@@ -94,6 +103,11 @@ Knot_View::Knot_View(QString file)
 
 }
 
+Knot_View::~Knot_View()
+{
+    Graph_Item::set_selection_observer(scene(),nullptr);
+}
+
 void Knot_View::copy_graph_style(const Graph &g)
 {
     begin_macro("Copy Style");
@@ -118,13 +132,18 @@ void Knot_View::copy_graph_style(const Graph &g)
 }
 
 
-bool Knot_View::load_file(QIODevice &device, QString action_name )
+bool Knot_View::load_file(QIODevice &device, QString action_name, bool mark_clean )
 {
     Graph loaded;
     if (  !import_xml(device,loaded) )
         return false;
 
+    load_graph(loaded,action_name,mark_clean);
+    return true;
+}
 
+void Knot_View::load_graph(const Graph &loaded, QString action_name, bool mark_clean)
+{
     begin_macro(action_name);
 
 
@@ -159,12 +178,11 @@ bool Knot_View::load_file(QIODevice &device, QString action_name )
     }
 
     end_macro();
-    undo_stack.setClean();
+    if ( mark_clean )
+        undo_stack.setClean();
 
 
     view_fit();
-
-    return true;
 }
 
 
@@ -187,6 +205,24 @@ bool Knot_View::load_file(QString fname)
     return false;
 }
 
+void Knot_View::load_file(const Graph &loaded, QString fname)
+{
+    load_graph(loaded,tr("Load File"));
+    setWindowFilePath(fname);
+    m_file_name = fname;
+}
+
+bool Knot_View::recover_file(QString recovery_file, QString original_file)
+{
+    QFile file(recovery_file);
+    if ( !load_file(file,tr("Recover File"),false) )
+        return false;
+
+    setWindowFilePath(original_file);
+    m_file_name = original_file;
+    return true;
+}
+
 bool Knot_View::save_file(QString fname)
 {
     QFile file(fname);
@@ -410,17 +446,58 @@ void Knot_View::flip_vert_selection()
 
 void Knot_View::update_selection(bool select_edges)
 {
+    if ( render_suspended )
+    {
+        // changed_nodes keeps collecting until the update is performed
+        selection_pending = true;
+        selection_edges_pending = selection_edges_pending || select_edges;
+        return;
+    }
+
     node_mover.set_nodes(selected_nodes());
 
     if ( select_edges )
-        foreach(Edge* e, m_graph.edges())
-        {
-            e->setSelected( e->vertex1()->isSelected() && e->vertex2()->isSelected() );
-        }
+    {
+        foreach(Node* n, changed_nodes)
+            foreach(Edge* e, n->edges())
+            {
+                e->setSelected( e->vertex1()->isSelected() && e->vertex2()->isSelected() );
+            }
+    }
+    changed_nodes.clear();
+
+    if ( !selection_notify_pending )
+    {
+        selection_notify_pending = true;
+        QMetaObject::invokeMethod(this,"emit_selection_changed",Qt::QueuedConnection);
+    }
+}
 
+void Knot_View::emit_selection_changed()
+{
+    selection_notify_pending = false;
     emit selection_changed(node_mover.nodes(),selected_edges());
 }
 
+void Knot_View::item_selection_changed(Graph_Item *item, bool selected)
+{
+    if ( Node* node = qobject_cast<Node*>(item) )
+    {
+        if ( selected )
+            m_selected_nodes.insert(node);
+        else
+            m_selected_nodes.remove(node);
+        changed_nodes.insert(node);
+    }
+    else if ( Edge* edge = qobject_cast<Edge*>(item) )
+    {
+        if ( selected )
+            m_selected_edges.insert(edge);
+        else
+            m_selected_edges.remove(edge);
+    }
+}
+
 void Knot_View::set_display_graph(bool enable)
 {
     paint_graph = enable;
@@ -497,6 +574,25 @@ void Knot_View::remove_node(Node *node)
     end_macro();
 }
 
+void Knot_View::remove_nodes(const QList<Node *> &nodes, QString message)
+{
+    begin_macro(message);
+    QSet<Edge*> removed;
+    foreach(Node* node, nodes)
+    {
+        foreach(Edge* e, node->edges())
+        {
+            if ( !removed.contains(e) && e->scene() == scene() )
+            {
+                removed.insert(e);
+                remove_edge(e);
+            }
+        }
+        push_command(new Remove_Node(node,this));
+    }
+    end_macro();
+}
+
 void Knot_View::begin_macro(QString name)
 {
     macro_stack.push( new Knot_Macro(name,this,nullptr) );
@@ -518,28 +614,49 @@ void Knot_View::push_command(Knot_Command *cmd)
         undo_stack.push(cmd);
 }
 
-QList<Node *> Knot_View::selected_nodes() const
+void Knot_View::suspend_render()
+{
+    render_suspended++;
+}
+
+void Knot_View::resume_render()
 {
-    QList<Node*> nl;
-    foreach ( QGraphicsItem* it, scene()->selectedItems() )
+    if ( render_suspended <= 0 || --render_suspended > 0 )
+        return;
+
+    if ( selection_pending )
+    {
+        selection_pending = false;
+        bool select_edges = selection_edges_pending;
+        selection_edges_pending = false;
+        update_selection(select_edges);
+    }
+
+    if ( render_pending )
     {
-        Node* n = dynamic_cast<Node*>(it);
-        if(n)
-            nl.push_back(n);
+        render_pending = false;
+        update_knot();
     }
-    return nl;
 }
 
-QList<Edge *> Knot_View::selected_edges() const
+void Knot_View::flush_render()
 {
-    QList<Edge*> nl;
-    foreach ( QGraphicsItem* it, scene()->selectedItems() )
+    if ( render_pending )
     {
-        Edge* n = dynamic_cast<Edge*>(it);
-        if(n)
-            nl.push_back(n);
+        render_pending = false;
+        m_graph.render_knot();
+        scene()->invalidate();
     }
-    return nl;
+}
+
+QList<Node *> Knot_View::selected_nodes() const
+{
+    return m_selected_nodes.toList();
+}
+
+QList<Edge *> Knot_View::selected_edges() const
+{
+    return m_selected_edges.toList();
 }
 
 
@@ -620,6 +737,12 @@ void Knot_View::set_mode_move_background()
 
 void Knot_View::update_knot()
 {
+    if ( render_suspended )
+    {
+        render_pending = true;
+        return;
+    }
+
     m_graph.render_knot();
     scene()->invalidate();
 }
@@ -716,7 +839,7 @@ void Knot_View::rubberband_select(QList<Node *> nodes, bool modifier)
 
 void Knot_View::check_plugins()
 {
-    if ( !resource_manager().cusp_shapes().contains(m_graph.default_node_style().cusp_shape) )
+    if ( !resource_manager().has_cusp_shape(m_graph.default_node_style().cusp_shape) )
     {
         m_graph.default_node_style_reference().cusp_shape =
                 resource_manager().default_cusp_shape();
@@ -724,18 +847,22 @@ void Knot_View::check_plugins()
     foreach(Node* n, m_graph.nodes())
     {
         if ( n->style().enabled_style & Node_Style::CUSP_SHAPE &&
-             !resource_manager().cusp_shapes().contains(n->style().cusp_shape) )
+             !resource_manager().has_cusp_shape(n->style().cusp_shape) )
         {
-            n->style().cusp_shape = nullptr;
-            n->style().enabled_style ^= Node_Style::CUSP_SHAPE;
+            Node_Style style = n->style();
+            style.cusp_shape = nullptr;
+            style.enabled_style ^= Node_Style::CUSP_SHAPE;
+            n->set_style(style);
         }
     }
 
     foreach(Edge* e, m_graph.edges())
     {
-        if ( !resource_manager().edge_types().contains(e->style().edge_type) )
+        if ( !resource_manager().has_edge_type(e->style().edge_type) )
         {
-            e->style().edge_type = resource_manager().default_edge_type();
+            Edge_Style style = e->style();
+            style.edge_type = resource_manager().default_edge_type();
+            e->set_style(style);
         }
     }
 }
@@ -853,6 +980,7 @@ void Knot_View::reset_view()
 
 void Knot_View::mousePressEvent(QMouseEvent *event)
 {
+    TRACE_SCOPE("Knot_View::mousePressEvent");
     QPoint mpos = event->pos();
     QPointF scene_pos = mapToScene(mpos);
     QPointF snapped_scene_pos = m_grid.nearest(scene_pos);
@@ -902,6 +1030,7 @@ void Knot_View::mousePressEvent(QMouseEvent *event)
 
 void Knot_View::mouseMoveEvent(QMouseEvent *event)
 {
+    TRACE_SCOPE("Knot_View::mouseMoveEvent");
     QPoint mpos = event->pos();
     QPointF scene_pos = mapToScene(mpos);
     QPointF snapped_scene_pos = m_grid.nearest(scene_pos);
@@ -988,7 +1117,7 @@ void Knot_View::mouseMoveEvent(QMouseEvent *event)
 
 void Knot_View::mouseReleaseEvent(QMouseEvent *event)
 {
-
+    TRACE_SCOPE("Knot_View::mouseReleaseEvent");
     QPoint mpos = event->pos();
     QPointF scene_pos = mapToScene(mpos);
     QPointF snapped_scene_pos = m_grid.nearest(scene_pos);
@@ -1044,7 +1173,7 @@ void Knot_View::mouseReleaseEvent(QMouseEvent *event)
 
 void Knot_View::mouseDoubleClickEvent(QMouseEvent *event)
 {
-
+    TRACE_SCOPE("Knot_View::mouseDoubleClickEvent");
     QPoint mpos = event->pos();
     QPointF scene_pos = mapToScene(mpos);
     QPointF snapped_scene_pos = m_grid.nearest(scene_pos);
@@ -1054,6 +1183,7 @@ void Knot_View::mouseDoubleClickEvent(QMouseEvent *event)
 
 void Knot_View::wheelEvent(QWheelEvent *event)
 {
+    TRACE_SCOPE("Knot_View::wheelEvent");
     if ( event->modifiers() & Qt::ControlModifier )
     {
         if ( event->delta() < 0 )
@@ -1110,12 +1240,87 @@ QList<Node *> Knot_View::nodes_in_rubberband() const
 void Knot_View::drawBackground(QPainter *painter, const QRectF &rect)
 {
     painter->fillRect(rect,backgroundBrush());
-    bg_img.render(painter);
+    bg_img.render(painter,rect);
     m_grid.render(painter,rect);
 }
 
 
 
+void Knot_View::drawForeground(QPainter *, const QRectF &)
+{
+    paint_times.push_back(paint_clock.elapsed());
+    paints_per_second(); // drops the older paints
+}
+
+void Knot_View::paintEvent(QPaintEvent *event)
+{
+    QGraphicsView::paintEvent(event);
+    Startup_Profile::instance().mark_frame_painted();
+
+    if ( !m_show_render_stats )
+        return;
+
+    int paint_rate = paints_per_second();
+
+    const Render_Stats& stats = m_graph.render_stats();
+    QStringList lines;
+    lines << tr("Render: %1 ms").arg(stats.render()/1e6,0,'f',2)
+          << tr("  Traversal: %1 ms").arg(stats.traverse/1e6,0,'f',2)
+          << tr("  Path build: %1 ms").arg(stats.path_build/1e6,0,'f',2)
+          << tr("  Bounding box: %1 ms").arg(stats.bounding_box/1e6,0,'f',2)
+          << tr("Paint: %1 ms").arg(stats.paint/1e6,0,'f',2)
+          << tr("Paints/s: %1").arg(paint_rate)
+          << tr("Nodes: %1").arg(m_graph.nodes().size())
+          << tr("Edges: %1").arg(m_graph.edges().size())
+          << tr("Loops: %1").arg(stats.loops)
+          << tr("Segments: %1").arg(stats.segments);
+    QString text = lines.join("\n");
+
+    // Painted on the viewport, unaffected by zoom and scrolling
+    QPainter painter(viewport());
+    QFontMetrics metrics(font());
+    QRect box = metrics.boundingRect(QRect(0,0,width(),height()),Qt::AlignLeft|Qt::AlignTop,text);
+    box.moveTopLeft(QPoint(12,12));
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0,0,0,160));
+    painter.drawRect(box.adjusted(-4,-4,4,4));
+    painter.setPen(Qt::white);
+    painter.setFont(font());
+    painter.drawText(box,Qt::AlignLeft|Qt::AlignTop,text);
+}
+
+void Knot_View::set_show_render_stats(bool show)
+{
+    if ( show == m_show_render_stats )
+        return;
+
+    m_show_render_stats = show;
+
+    /*
+        Partial updates and scrolling would only repaint or move pieces
+        of the overlay, leaving stale numbers behind
+    */
+    if ( show )
+    {
+        update_mode = viewportUpdateMode();
+        setViewportUpdateMode(FullViewportUpdate);
+    }
+    else
+    {
+        setViewportUpdateMode(update_mode);
+    }
+
+    viewport()->update();
+}
+
+int Knot_View::paints_per_second() const
+{
+    qint64 since = paint_clock.elapsed() - 1000;
+    while ( !paint_times.empty() && paint_times.front() < since )
+        paint_times.pop_front();
+    return paint_times.size();
+}
+
 void Knot_View::set_mouse_mode(Mouse_Mode mode)
 {
     mouse_mode = mode;
@@ -36,11 +36,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStack>
 #include "pen_join_style_metatype.hpp"
 #include "knot_tool.hpp"
+#include <QSet>
+#include <QElapsedTimer>
 
 class Context_Menu_Node;
 class Context_Menu_Edge;
 
-class Knot_View : public QGraphicsView
+class Knot_View : public QGraphicsView, private Selection_Observer
 {
     Q_OBJECT
 
@@ -93,18 +95,40 @@ class Knot_View : public QGraphicsView
     Edge_Chain_Tool  tool_edge_chain;
     Toggle_Edge_Tool tool_toggle_edge;
 
+    QSet<Node*>         m_selected_nodes;
+    QSet<Edge*>         m_selected_edges;
+    QSet<Node*>         changed_nodes; ///< Nodes (de)selected since the last update_selection()
+    bool                selection_notify_pending; ///< Whether selection_changed() has been scheduled
+    int                 render_suspended; ///< Nesting level of suspend_render()
+    bool                render_pending;   ///< Whether update_knot() has been called while suspended
+    bool                selection_pending;///< Whether update_selection() has been called while suspended
+    bool                selection_edges_pending; ///< Whether the deferred update_selection() selects edges
+    bool                m_show_render_stats; ///< Whether to draw the render statistics overlay
+    ViewportUpdateMode  update_mode; ///< Update mode to restore once the overlay is hidden
+    QElapsedTimer       paint_clock;
+    mutable QList<qint64> paint_times; ///< Milliseconds on paint_clock of the paints in the last second
+    int                 m_revision; ///< Incremented whenever the undo stack index changes
+
 public:
 
     /**
      *  \param file File name, if empty no file is loaded
     */
     Knot_View ( QString file = QString() );
+    ~Knot_View();
 
     QString file_name() const { return m_file_name; }
     void set_file_name(QString name) {m_file_name = name;}
 
     QUndoStack* undo_stack_pointer() { return &undo_stack; }
 
+    /**
+     * \brief Number identifying the current contents of the document
+     *
+     * Unlike the undo index, it changes on every undo, redo and new command
+     */
+    int revision() const { return m_revision; }
+
     Snapping_Grid& grid() { return m_grid; }
 
     Background_Image& background_image() { return bg_img; }
@@ -172,6 +196,13 @@ public:
     */
     void remove_node(Node* node);
 
+    /**
+     *  \brief Removes nodes and their edges as a single action
+     *
+     *  Each edge is removed once, even if both its vertices are in the list.
+    */
+    void remove_nodes(const QList<Node*>& nodes, QString message);
+
     /**
      *  \brief Begins a command macro
      */
@@ -185,6 +216,30 @@ public:
      */
     void push_command( class Knot_Command* cmd );
 
+    /**
+     *  \brief Defer knot rendering and selection updates
+     *
+     *  Calls to update_knot() and update_selection() are coalesced until the
+     *  outermost resume_render(), which performs them once.
+     *  Calls can be nested.
+     *  \sa Deferred_Render
+     */
+    void suspend_render();
+    /**
+     *  \brief Ends a suspend_render() scope
+     *
+     *  When the outermost scope ends, pending updates are performed
+     */
+    void resume_render();
+    /// Whether rendering is currently deferred
+    bool render_is_suspended() const { return render_suspended > 0; }
+    /**
+     *  \brief Perform a deferred render without ending the suspension
+     *
+     *  Used when the rendered paths are needed before resume_render()
+     */
+    void flush_render();
+
 
 
     /**
@@ -196,10 +251,12 @@ public:
 
     /**
      *  \brief List of currenty selected nodes on the view
+     *  \note Linear in the number of selected nodes
     */
     QList<Node*> selected_nodes() const;
     /**
      *  \brief List of currenty selected edges on the view
+     *  \note Linear in the number of selected edges
     */
     QList<Edge *> selected_edges() const;
 
@@ -228,10 +285,35 @@ public:
     bool edge_loop_mode_enabled() const;
     bool toggle_edges_mode_enabled() const;
 
-    bool load_file(QIODevice &device, QString action_name);
+    /**
+     * \brief Replace the graph with the contents of \p device
+     * \param mark_clean Whether the loaded contents count as saved
+     */
+    bool load_file(QIODevice &device, QString action_name, bool mark_clean = true);
+
+    /**
+     * \brief Replace the graph with the nodes and edges of \p loaded
+     *
+     * The view takes ownership of the nodes and edges
+     * \param mark_clean Whether the loaded contents count as saved
+     */
+    void load_graph(const Graph& loaded, QString action_name, bool mark_clean = true);
 
     void set_display_graph(bool enable);
 
+    /**
+     *  \brief Show an overlay with the render statistics
+     *
+     *  It shows the timing of the last render and paint of the knot and the
+     *  size of the graph
+     */
+    void set_show_render_stats(bool show);
+    bool show_render_stats() const { return m_show_render_stats; }
+    /// Timing of the last render and paint of the knot
+    const Render_Stats& render_stats() const { return m_graph.render_stats(); }
+    /// Number of times the view has been painted in the last second
+    int paints_per_second() const;
+
     /**
      *  \brief Place new nodes on the view
      *
@@ -359,6 +441,22 @@ public slots:
      */
     bool load_file(QString fname);
 
+    /**
+     * \brief Load a crash recovery snapshot
+     * \param recovery_file Snapshot to be loaded
+     * \param original_file File the snapshot was taken from, may be empty
+     * \post The contents are marked as modified and will be saved as \p original_file
+     * \return Whether the snapshot was loaded successfully
+     */
+    bool recover_file(QString recovery_file, QString original_file);
+
+    /**
+     * \brief Show a graph loaded from \p fname (eg: by Knot_Loader)
+     * \post The view owns the nodes and edges of \p loaded and
+     *       the file name is updated to match \p fname
+     */
+    void load_file(const Graph& loaded, QString fname);
+
     /**
      * \brief Save file and update file name
      * \post If no proble was encountered the clean state and file name are updated
@@ -393,7 +491,11 @@ public slots:
 
     /**
      *  \brief updates the transform handles
-     *  \param select_edges whether the edges bewteen the selected nodes should be selected
+     *  \param select_edges whether the edges bewteen the selected nodes should be selected,
+     *         only the edges of nodes (de)selected since the last call are checked
+     *
+     *  selection_changed() is emitted once the control returns to the event loop
+     *  so several updates in a row result in a single notification.
      */
     void update_selection(bool select_edges=true);
 
@@ -424,6 +526,9 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent *event);
     void wheelEvent(QWheelEvent *event);
     void drawBackground(QPainter *painter, const QRectF &rect);
+    void drawForeground(QPainter *painter, const QRectF &rect);
+    /// Draws the render statistics overlay on top of the scene
+    void paintEvent(QPaintEvent *event);
 
     /**
      *  \brief Expand sceneRect to contain the visible area
@@ -455,7 +560,14 @@ private slots:
      */
     void check_plugins();
 
+    /// Emit selection_changed() for all the changes since it was scheduled
+    void emit_selection_changed();
+
+    void bump_revision() { m_revision++; }
+
 private:
+    void item_selection_changed(Graph_Item* item, bool selected) override;
+
     /**
      *  \brief Get node at location
      *  \return The found node or NULL
@@ -497,4 +609,36 @@ private:
 
 };
 
+/**
+ *  \brief Suspends rendering of a Knot_View for its lifetime
+ *
+ *  \code
+ *  {
+ *      Deferred_Render defer(view);
+ *      // several commands, the knot is rendered once at the end of the scope
+ *  }
+ *  \endcode
+ */
+class Deferred_Render
+{
+    Knot_View* view;
+
+public:
+    explicit Deferred_Render(Knot_View* view) : view(view)
+    {
+        if ( view )
+            view->suspend_render();
+    }
+
+    ~Deferred_Render()
+    {
+        if ( view )
+            view->resume_render();
+    }
+
+private:
+    Deferred_Render(const Deferred_Render&);
+    Deferred_Render& operator=(const Deferred_Render&);
+};
+
 #endif // KNOT_VIEW_HPP
@@ -87,12 +87,7 @@ void Node_Mover::update_transform_handles()
         else
             transform_handles[i].set_angle(rotate_angle);
 
-        QPointF off = transform_handles[i].pos()-start_pos;
-        QLineF ray(QPointF(0,0),off);
-        ray.setLength(ray.length()*scale_factor);
-        ray.setAngle(ray.angle()+rotate_angle);
-
-        transform_handles[i].setPos(pivot+ray.p2());
+        transform_handles[i].setPos(transformed(transform_handles[i].pos()-start_pos));
     }
 }
 
@@ -190,11 +185,13 @@ void Node_Mover::initialize_movement_internal(QPointF pivot)
     scale_count = 0;
     rotate_angle = 0;
 
-    offset.clear();
-    offset.reserve(m_nodes.size());
-
-    foreach(Node* n,m_nodes)
-        offset.push_back(n->pos() - pivot);
+    offset_x.resize(m_nodes.size());
+    offset_y.resize(m_nodes.size());
+    for ( int i = 0; i < m_nodes.size(); i++ )
+    {
+        offset_x[i] = m_nodes[i]->x() - pivot.x();
+        offset_y[i] = m_nodes[i]->y() - pivot.y();
+    }
 }
 
 void Node_Mover::initialize_movement(QPointF pivot)
@@ -206,15 +203,7 @@ void Node_Mover::initialize_movement(QPointF pivot)
 void Node_Mover::move(QPointF delta)
 {
     pivot += delta;
-    foreach(Node* n,m_nodes)
-    {
-        n->setPos(n->pos()+delta);
-    }
-
-
-    update_transform_handles();
-    //for ( int i = 0; i < n_handles; i++ )
-    //    transform_handles[i].setPos(transform_handles[i].pos()+delta);
+    apply_transform();
 }
 
 void Node_Mover::set_pos(QPointF p)
@@ -225,26 +214,13 @@ void Node_Mover::set_pos(QPointF p)
 void Node_Mover::rotate(double angle)
 {
     rotate_angle += angle;
-    foreach(Node* n,m_nodes)
-    {
-        QLineF ray(pivot,n->pos());
-        ray.setAngle(ray.angle()+angle);
-        n->setPos(ray.p2());
-    }
-    update_transform_handles();
+    apply_transform();
 }
 
 void Node_Mover::scale(double factor)
 {
     scale_factor *= factor;
-    for ( int i = 0; i < m_nodes.size(); i++ )
-    {
-        QLineF ray(QPointF(0,0),offset[i]);
-        ray.setLength(ray.length()*scale_factor);
-        ray.setAngle(ray.angle()+rotate_angle);
-        m_nodes[i]->setPos(pivot+ray.p2());
-    }
-    update_transform_handles();
+    apply_transform();
 }
 
 void Node_Mover::fixed_scale(bool increase, double step_size)
@@ -254,13 +230,45 @@ void Node_Mover::fixed_scale(bool increase, double step_size)
     double factor = ( m_initial_box.width() + scale_count*step_size ) /
                                 m_initial_box.width();
     scale_factor = factor;
-    for ( int i = 0; i < m_nodes.size(); i++ )
+    apply_transform();
+}
+
+QPointF Node_Mover::transformed(QPointF offset) const
+{
+    // angles grow counterclockwise on screen, where y points down
+    double angle = deg2rad(rotate_angle);
+    double c = scale_factor*qCos(angle);
+    double s = scale_factor*qSin(angle);
+    return QPointF(pivot.x() + c*offset.x() + s*offset.y(),
+                   pivot.y() - s*offset.x() + c*offset.y());
+}
+
+void Node_Mover::apply_transform()
+{
+    const int n = m_nodes.size();
+    double angle = deg2rad(rotate_angle);
+    const double c = scale_factor*qCos(angle);
+    const double s = scale_factor*qSin(angle);
+    const double px = pivot.x();
+    const double py = pivot.y();
+
+    result_x.resize(n);
+    result_y.resize(n);
+    const double* ox = offset_x.constData();
+    const double* oy = offset_y.constData();
+    double* rx = result_x.data();
+    double* ry = result_y.data();
+
+    // no branches or calls, the compiler can vectorize this
+    for ( int i = 0; i < n; i++ )
     {
-        QLineF ray(QPointF(0,0),offset[i]);
-        ray.setLength(ray.length()*scale_factor);
-        ray.setAngle(ray.angle()+rotate_angle);
-        m_nodes[i]->setPos(pivot+ray.p2());
+        rx[i] = px + c*ox[i] + s*oy[i];
+        ry[i] = py - s*ox[i] + c*oy[i];
     }
+
+    for ( int i = 0; i < n; i++ )
+        m_nodes[i]->setPos(rx[i],ry[i]);
+
     update_transform_handles();
 }
 
@@ -275,14 +283,14 @@ void Node_Mover::deploy(Knot_View *view,QString message)
             for ( int i = 0; i < m_nodes.size(); i++ )
             {
                 Node* n = m_nodes[i];
-                view->push_command(new Move_Node(n,offset[i]+start_pos,n->pos(),view));
+                view->push_command(new Move_Node(n,QPointF(offset_x[i],offset_y[i])+start_pos,n->pos(),view));
             }
             view->end_macro();
         }
         else if ( m_nodes.size() == 1 )
         {
             Node* n = m_nodes[0];
-            view->push_command(new Move_Node(n,offset[0]+start_pos,n->pos(),view));
+            view->push_command(new Move_Node(n,QPointF(offset_x[0],offset_y[0])+start_pos,n->pos(),view));
         }
     }
     //initialize_movement(pivot);
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "node.hpp"
 #include <QUndoStack>
+#include <QVector>
 #include "transform_handle.hpp"
 /**
  *  Class that manages all the stuff needed to transform nodes
@@ -39,7 +40,10 @@ private:
     QList<Node*>        m_nodes;
     QPointF             pivot; ///< Pivot point for movement
     QPointF             start_pos;///< Starting pivot point position
-    QList<QPointF>      offset; ///< Offset of each node from pivot
+    QVector<double>     offset_x; ///< Offset of each node from pivot on initialization
+    QVector<double>     offset_y; ///< Offset of each node from pivot on initialization
+    QVector<double>     result_x; ///< Buffer for the transformed node positions
+    QVector<double>     result_y; ///< Buffer for the transformed node positions
     double              scale_factor;
     int                 scale_count; ///< Number of size units when using fixed_scale
     double              rotate_angle;
@@ -123,6 +127,18 @@ private:
     /// Initialize movement without updating handles
     void initialize_movement_internal(QPointF pivot );
 
+    /**
+     *  \brief Set the position of all the nodes from their initial offset
+     *
+     *  Movement, rotation and scaling are combined in a single affine
+     *  transformation which is computed for all the nodes before
+     *  any of them is moved.
+     */
+    void apply_transform();
+
+    /// Current transformation of an offset from the starting pivot position
+    QPointF transformed(QPointF offset) const;
+
 
 };
 
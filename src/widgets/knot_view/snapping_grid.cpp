@@ -25,8 +25,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "snapping_grid.hpp"
-#include <QVarLengthArray>
 #include <QLineF>
+#include <qmath.h>
 
 static const double sqrt3 = 1.732050808;
 
@@ -35,28 +35,27 @@ QColor Snapping_Grid::line_color(Qt::lightGray);
 Snapping_Grid::Snapping_Grid(unsigned size, Snapping_Grid::Grid_Shape shape,
                              QPointF origin, bool enabled)
     : m_size(size > 0 ? size : 1), m_shape(shape),
-      m_origin(origin), m_enabled(enabled)
+      m_origin(origin), m_enabled(enabled), faded_lines(true)
 {
 }
 
-void Snapping_Grid::snap(QPointF &p) const
+/// Move p to the closest point of a grid with the given parameters
+static void snap_point(QPointF &p, Snapping_Grid::Grid_Shape shape, double size,
+                       QPointF origin)
 {
-    if ( !m_enabled )
-        return;
-
-    if ( m_shape == SQUARE )
+    if ( shape == Snapping_Grid::SQUARE )
     {
         /**
             Square grid, simple enough
         */
-        p -= m_origin;
-        p /= m_size;
+        p -= origin;
+        p /= size;
         p.setX(qRound64(p.x()));
         p.setY(qRound64(p.y()));
-        p *= m_size;
-        p += m_origin;
+        p *= size;
+        p += origin;
     }
-    else if ( m_shape == TRIANGLE1 )
+    else if ( shape == Snapping_Grid::TRIANGLE1 )
     {
         /**
             Triangular grid, find intersection of line1 and line2
@@ -74,89 +73,185 @@ void Snapping_Grid::snap(QPointF &p) const
             the p -= origin, p += origin is to transform the coordinates
             relative to the grid origin
         */
-        p -= m_origin;
-        double y_factor = m_size * sqrt3/2.0;
+        p -= origin;
+        double y_factor = size * sqrt3/2.0;
         qint64 n2 = qRound64(p.y()/y_factor);
         p.setY(n2*y_factor);
-        qint64 n1 = qRound64 ( p.x()/m_size - n2/2.0 );
-        p.setX(m_size*(n2/2.0+n1));
-        p+=m_origin;
+        qint64 n1 = qRound64 ( p.x()/size - n2/2.0 );
+        p.setX(size*(n2/2.0+n1));
+        p+=origin;
     }
-    else if ( m_shape == TRIANGLE2 )
+    else if ( shape == Snapping_Grid::TRIANGLE2 )
     {
-        p -= m_origin;
-        double x_factor = m_size * sqrt3/2.0;
+        p -= origin;
+        double x_factor = size * sqrt3/2.0;
         qint64 n2 = qRound64(p.x()/x_factor);
         p.setX(n2*x_factor);
-        qint64 n1 = qRound64 ( p.y()/m_size - n2/2.0 );
-        p.setY(m_size*(n2/2.0+n1));
-        p+=m_origin;
+        qint64 n1 = qRound64 ( p.y()/size - n2/2.0 );
+        p.setY(size*(n2/2.0+n1));
+        p+=origin;
     }
 }
 
-void Snapping_Grid::render(QPainter *painter, const QRectF &rect) const
+/**
+ * \brief Whether a line is also on the grid with twice the size
+ * \param offset Distance of the line from the origin along the line spacing
+ * \param step   Line spacing
+ */
+static bool on_double_grid(double offset, double step)
 {
+    return qRound64(offset/step) % 2 == 0;
+}
 
-    if ( !m_enabled )
-        return;
-    painter->setPen(QPen(line_color,0));
-    painter->drawEllipse(m_origin,5,5);
-    QPointF topleft = nearest(rect.left()-m_size,rect.top()-m_size);
+/**
+ * \brief Append to lines the lines of a grid that cover at least rect
+ * \param half_steps If \c true, only append the lines that aren't part of
+ *                   the grid with twice the size
+ */
+static void grid_lines(QVector<QLineF>& lines, Snapping_Grid::Grid_Shape shape,
+                       double size, QPointF origin, const QRectF &rect,
+                       bool half_steps)
+{
+    QPointF topleft(rect.left()-size,rect.top()-size);
+    snap_point(topleft,shape,size,origin);
 
-    QVarLengthArray<QLineF, 128> lines;
-    if ( m_shape == Snapping_Grid::SQUARE )
+    if ( shape == Snapping_Grid::SQUARE )
     {
-        for (double x = topleft.x(); x < rect.right(); x += m_size)
+        for (double x = topleft.x(); x < rect.right(); x += size)
+            if ( !half_steps || !on_double_grid(x-origin.x(),size) )
                 lines.append(QLineF(x, rect.top(), x, rect.bottom()));
-        for (double y = topleft.y(); y < rect.bottom(); y += m_size)
+        for (double y = topleft.y(); y < rect.bottom(); y += size)
+            if ( !half_steps || !on_double_grid(y-origin.y(),size) )
                 lines.append(QLineF(rect.left(), y, rect.right(), y));
     }
-    else if ( m_shape == Snapping_Grid::TRIANGLE1 )
+    else if ( shape == Snapping_Grid::TRIANGLE1 )
     {
-        double y_factor = m_size*sqrt3/2.0;
+        double y_factor = size*sqrt3/2.0;
         double y;
         for ( y = topleft.y(); y < rect.bottom(); y += y_factor)
+            if ( !half_steps || !on_double_grid(y-origin.y(),y_factor) )
                 lines.append(QLineF(rect.left(), y, rect.right(), y));
 
         double slope =  sqrt3;
+        // Horizontal distance between topleft and the origin row along the diagonals
+        double shift = (topleft.y()-origin.y())/slope;
         double x = topleft.x();
-        for ( double x2 = x; x2 < rect.right(); x += m_size )
+        for ( double x2 = x; x2 < rect.right(); x += size )
         {
             x2 = (rect.bottom()-topleft.y())/(-slope)+x;
-            lines.append(QLineF(x, topleft.y(),x2,rect.bottom() ));
+            if ( !half_steps || !on_double_grid(x+shift-origin.x(),size) )
+                lines.append(QLineF(x, topleft.y(),x2,rect.bottom() ));
         }
 
-        for ( double x2 = x; x2 > rect.left(); x -= m_size )
+        for ( double x2 = x; x2 > rect.left(); x -= size )
         {
             x2 = (rect.bottom()-topleft.y())/(slope)+x;
-            lines.append(QLineF(x, topleft.y(),x2,rect.bottom() ));
+            if ( !half_steps || !on_double_grid(x-shift-origin.x(),size) )
+                lines.append(QLineF(x, topleft.y(),x2,rect.bottom() ));
         }
 
     }
-    else if ( m_shape == Snapping_Grid::TRIANGLE2 )
+    else if ( shape == Snapping_Grid::TRIANGLE2 )
     {
-        double x_factor = m_size*sqrt3/2.0;
+        double x_factor = size*sqrt3/2.0;
         double x;
         for ( x = topleft.x(); x < rect.right(); x += x_factor)
+            if ( !half_steps || !on_double_grid(x-origin.x(),x_factor) )
                 lines.append(QLineF(x,rect.top(), x, rect.bottom()));
 
         double slope =  sqrt3;
+        // Vertical distance between topleft and the origin column along the diagonals
+        double shift = (topleft.x()-origin.x())/slope;
         double y = topleft.y();
-        for ( double y2 = y; y2 < rect.bottom(); y += m_size )
+        for ( double y2 = y; y2 < rect.bottom(); y += size )
         {
             y2 = (rect.right()-topleft.x())/(-slope)+y;
-            lines.append(QLineF(topleft.x(),y,rect.right(),y2 ));
+            if ( !half_steps || !on_double_grid(y+shift-origin.y(),size) )
+                lines.append(QLineF(topleft.x(),y,rect.right(),y2 ));
         }
 
-        for ( double y2 = y; y2 > rect.top(); y -= m_size )
+        for ( double y2 = y; y2 > rect.top(); y -= size )
         {
             y2 = (rect.right()-topleft.x())/(slope)+y;
-            lines.append(QLineF(topleft.x(),y,rect.right(),y2 ));
+            if ( !half_steps || !on_double_grid(y-shift-origin.y(),size) )
+                lines.append(QLineF(topleft.x(),y,rect.right(),y2 ));
         }
 
     }
+}
+
+void Snapping_Grid::snap(QPointF &p) const
+{
+    if ( !m_enabled )
+        return;
+
+    snap_point(p,m_shape,m_size,m_origin);
+}
+
+const QVector<QLineF>& Snapping_Grid::Line_Cache::get(double size,
+    Grid_Shape shape, QPointF origin, const QRectF &rect)
+{
+    /*
+        Reuse the lines if they still cover rect, unless they extend so far
+        that drawing them would cost more than generating new ones
+    */
+    if ( size == this->size && shape == this->shape && origin == this->origin &&
+         this->rect.contains(rect) &&
+         this->rect.width()*this->rect.height() <= 4*rect.width()*rect.height() )
+        return lines;
+
+    this->size = size;
+    this->shape = shape;
+    this->origin = origin;
+    // Leave some margin so scrolling doesn't regenerate the lines right away
+    double margin_x = rect.width()/4;
+    double margin_y = rect.height()/4;
+    this->rect = rect.adjusted(-margin_x,-margin_y,margin_x,margin_y);
+
+    lines.clear();
+    grid_lines(lines,shape,size,origin,this->rect,half_steps);
+    return lines;
+}
+
+void Snapping_Grid::render(QPainter *painter, const QRectF &rect) const
+{
+
+    if ( !m_enabled )
+        return;
+    painter->setPen(QPen(line_color,0));
+    painter->drawEllipse(m_origin,5,5);
+
+    // Distance between parallel lines, in pixels
+    double scale = qSqrt(qAbs(painter->worldTransform().determinant()));
+    double spacing = m_size * scale;
+    if ( m_shape != SQUARE )
+        spacing *= sqrt3/2;
+    if ( spacing <= 0 )
+        return;
+
+    double size = m_size;
+    while ( spacing < min_line_spacing )
+    {
+        size *= 2;
+        spacing *= 2;
+    }
+
+    if ( size > m_size )
+    {
+        // Removed lines are between min_line_spacing/2 and min_line_spacing
+        // pixels apart, they become transparent as they get closer
+        double fade = (spacing - min_line_spacing) / min_line_spacing;
+        QColor faded_color = line_color;
+        faded_color.setAlphaF(line_color.alphaF()*fade);
+        if ( faded_color.alpha() > 0 )
+        {
+            painter->setPen(QPen(faded_color,0));
+            painter->drawLines(faded_lines.get(size/2,m_shape,m_origin,rect));
+            painter->setPen(QPen(line_color,0));
+        }
+    }
 
-    painter->drawLines(lines.data(), lines.size());
+    painter->drawLines(lines.get(size,m_shape,m_origin,rect));
 }
 
 void Snapping_Grid::enable(bool enable)
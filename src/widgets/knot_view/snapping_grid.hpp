@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QPainter>
+#include <QVector>
 
 class Snapping_Grid : public QObject
 {
@@ -39,12 +40,46 @@ public:
 
     static QColor line_color;
 
+    /**
+     * \brief Minimum distance in pixels between parallel lines
+     *
+     * Closer lines are decimated when rendering
+     */
+    static const int min_line_spacing = 6;
+
 protected:
     unsigned    m_size;
     Grid_Shape  m_shape;
     QPointF     m_origin;
     bool        m_enabled;
 
+private:
+    /**
+     * \brief Grid lines generated for a region of the scene
+     *
+     * Reused as long as the grid doesn't change and the region covers
+     * the area to be painted
+     */
+    struct Line_Cache
+    {
+        double          size;
+        Grid_Shape      shape;
+        QPointF         origin;
+        QRectF          rect;
+        QVector<QLineF> lines;
+        bool            half_steps; ///< Only lines not on the grid twice as large
+
+        explicit Line_Cache(bool half_steps = false)
+            : size(0), shape(SQUARE), half_steps(half_steps) {}
+
+        /// Lines covering rect for a grid with the given parameters
+        const QVector<QLineF>& get(double size, Grid_Shape shape,
+                                   QPointF origin, const QRectF& rect);
+    };
+
+    mutable Line_Cache  lines;
+    mutable Line_Cache  faded_lines; ///< Lines removed by decimation
+
 public:
     explicit Snapping_Grid ( unsigned size = 32,
                              Grid_Shape shape = SQUARE,
@@ -58,7 +93,13 @@ public:
     /// returns closest grid point
     QPointF nearest ( double x, double y ) const { return nearest(QPointF(x,y)); }
 
-    /// draws grid lines that cover at least rect
+    /**
+     * \brief draws grid lines that cover at least rect
+     *
+     * When lines would be closer than min_line_spacing pixels, only the
+     * lines of a grid 2, 4, 8... times larger are drawn and the remaining
+     * ones fade out as they get closer.
+     */
     void render (QPainter *painter, const QRectF &rect) const;
 
 